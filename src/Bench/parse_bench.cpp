@@ -0,0 +1,159 @@
+// Compares the former ifstream/istringstream/stoull parse of /proc/PID/stat
+// with parseProcStat() on the same in-memory lines, so only the parsing is
+// timed, not the reads.
+//
+//   mtop-parse-bench [--rounds N] [--copies N]
+//
+// The lines are snapshotted once from the live /proc; --copies repeats the
+// snapshot N times to make each round long enough to measure on a quiet host.
+#include "proc_stat.hpp"
+#include "proc_dir.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Result {
+    double ns_per_line = 0.0; // медиана по проходам
+    size_t parsed = 0;
+    uint64_t checksum = 0;    // чтобы компилятор не выбросил разбор
+};
+
+// Разбор в том виде, в каком он был в SystemInfo::readProcesses до ProcStatReader
+bool parseLegacy(const std::string& stat_line, ProcStat& out, std::string& name) {
+    size_t first_paren = stat_line.find('(');
+    size_t last_paren = stat_line.rfind(')');
+    if (first_paren == std::string::npos || last_paren == std::string::npos) return false;
+
+    name = stat_line.substr(first_paren + 1, last_paren - first_paren - 1);
+    std::string remaining = stat_line.substr(last_paren + 1);
+    std::istringstream iss(remaining);
+
+    std::vector<std::string> fields;
+    std::string field;
+    while (iss >> field) {
+        fields.push_back(field);
+    }
+    if (fields.size() < 22) return false;
+
+    out.state = fields[0][0];
+    out.ppid = std::stoi(fields[1]);
+    out.utime = std::stoull(fields[11]);
+    out.stime = std::stoull(fields[12]);
+    out.start_time = std::stoull(fields[19]);
+    out.rss_pages = std::stoull(fields[21]);
+    return true;
+}
+
+std::vector<std::string> snapshot(int copies) {
+    std::vector<std::string> lines;
+    PidEnumerator enumerator;
+    if (!enumerator.scan("/proc")) return lines;
+
+    char path[32];
+    char buffer[4096];
+    for (int pid : enumerator.ids()) {
+        std::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        close(fd);
+        if (n > 0) lines.emplace_back(buffer, static_cast<size_t>(n));
+    }
+
+    size_t unique = lines.size();
+    for (int copy = 1; copy < copies; ++copy) {
+        for (size_t i = 0; i < unique; ++i) lines.push_back(lines[i]);
+    }
+    return lines;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+template <typename Parse>
+Result measure(int rounds, const std::vector<std::string>& lines, Parse parse) {
+    using Clock = std::chrono::steady_clock;
+    Result result;
+    std::vector<double> times;
+
+    for (int round = -1; round < rounds; ++round) {
+        size_t parsed = 0;
+        uint64_t checksum = 0;
+        auto start = Clock::now();
+        for (const auto& line : lines) {
+            ProcStat stat{};
+            if (parse(line, stat)) {
+                parsed++;
+                checksum += stat.utime + stat.stime + stat.rss_pages + static_cast<uint64_t>(stat.ppid);
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (round < 0) continue; // первый проход только прогревает кэши
+        times.push_back(lines.empty() ? 0.0 : elapsed / static_cast<double>(lines.size()));
+        result.parsed = parsed;
+        result.checksum = checksum;
+    }
+    result.ns_per_line = median(times);
+    return result;
+}
+
+void print(const char* parser, const Result& result) {
+    std::printf("%-8s %10zu %12.1f %20llu\n", parser, result.parsed, result.ns_per_line,
+                static_cast<unsigned long long>(result.checksum));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int rounds = 50;
+    int copies = 10;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--copies") == 0 && i + 1 < argc) {
+            copies = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::fprintf(stderr, "Usage: %s [--rounds N] [--copies N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const std::vector<std::string> lines = snapshot(copies);
+    if (lines.empty()) {
+        std::fprintf(stderr, "Cannot read /proc\n");
+        return 1;
+    }
+
+    std::string name;
+    Result legacy = measure(rounds, lines, [&](const std::string& line, ProcStat& stat) {
+        try {
+            return parseLegacy(line, stat, name);
+        } catch (const std::exception&) {
+            return false;
+        }
+    });
+    Result scanner = measure(rounds, lines, [](const std::string& line, ProcStat& stat) {
+        return parseProcStat(line.data(), line.size(), stat);
+    });
+
+    std::printf("%-8s %10s %12s %20s\n", "parser", "lines", "ns/line", "checksum");
+    print("stream", legacy);
+    print("scanner", scanner);
+    if (scanner.ns_per_line > 0.0) {
+        std::printf("speedup  %.1fx\n", legacy.ns_per_line / scanner.ns_per_line);
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Times how long Display takes to build one frame into its FrameBuffer for
+// a synthetic snapshot of 20, 200 and 2000 process rows, with and without
+// colours. Only composing is timed and nothing is written to the terminal:
+// the cursor show/hide sequences Display sends to std::cout are discarded.
+//
+//   mtop-render-bench [--rounds N]
+//
+// allocs/frame counts operator new calls per frame after the first one and
+// should stay at zero.
+#include "display.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+size_t allocations = 0;
+
+} // namespace
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+constexpr int ROW_COUNTS[] = {20, 200, 2000};
+
+struct Result {
+    double us_per_frame = 0.0; // медиана по кадрам
+    size_t bytes = 0;
+    double allocs = 0.0;
+};
+
+// Снимок, похожий на занятый сервер: 16 ядер, история и строки разной длины
+SystemStats makeStats(int rows) {
+    static const char* const NAMES[] = {"postgres", "nginx", "java", "python3", "kworker/3:1-events", "sshd",
+                                        "systemd-journald", "redis-server"};
+    static const char* const USERS[] = {"root", "postgres", "www-data", "nobody"};
+
+    SystemStats stats{};
+    stats.cpu_percent = 37.5;
+    stats.total_memory_kb = 64ull << 20;
+    stats.used_memory_kb = 41ull << 20;
+    stats.free_memory_kb = stats.total_memory_kb - stats.used_memory_kb;
+    stats.load_avg[0] = 3.21;
+    stats.load_avg[1] = 2.75;
+    stats.load_avg[2] = 2.02;
+    stats.process_count = rows;
+
+    for (int cpu = 0; cpu < 16; ++cpu) {
+        double busy = (cpu * 37) % 100;
+        stats.cpu_cores.push_back({cpu, busy * 0.6, busy * 0.3, 1.0, 0.2, 0.3, 0.0, 0.0, busy});
+    }
+    for (int i = 0; i < 60; ++i) {
+        float value = static_cast<float>((i * 13) % 100);
+        stats.cpu_trend.push_back({value * 0.5f, value, value * 0.75f, 1});
+        stats.memory_trend.push_back({60.0f, 65.0f, 62.5f, 1});
+    }
+    stats.network_interfaces.push_back({"lo", 123456789, 123456789, 98765, 98765});
+    stats.network_interfaces.push_back({"eth0", 98765432100, 1234567890, 87654321, 7654321});
+
+    for (int i = 0; i < rows; ++i) {
+        ProcessInfo proc{};
+        proc.pid = 1000 + i * 7;
+        proc.tgid = proc.pid;
+        proc.ppid = 1 + i % 50;
+        proc.name = NAMES[i % 8];
+        proc.command = "/usr/bin/" + proc.name + " --config /etc/" + proc.name + "/main.conf --workers " +
+                       std::to_string(i % 32);
+        proc.state = i % 5 == 0 ? "R" : "S";
+        proc.cpu_percent = (i * 7919) % 1000 / 10.0;
+        proc.cpu_user_percent = proc.cpu_percent * 0.7;
+        proc.cpu_system_percent = proc.cpu_percent * 0.3;
+        proc.memory_kb = 1024ull * static_cast<uint64_t>((i * 104729) % 8192 + 1);
+        proc.pss_kb = proc.memory_kb / 2;
+        proc.uss_kb = proc.memory_kb / 3;
+        proc.swap_kb = i % 3 == 0 ? 4096 : 0;
+        proc.memory_detail = true;
+        proc.user = USERS[i % 4];
+        proc.group = USERS[i % 4];
+        proc.uid = i % 4 == 0 ? 0 : 1000 + i % 4;
+        proc.gid = proc.uid;
+        stats.processes.push_back(std::move(proc));
+    }
+    return stats;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+Result measure(bool colors, int rounds, const SystemStats& stats) {
+    using Clock = std::chrono::steady_clock;
+    MtopConfig config;
+    config.show_colors = colors;
+    config.show_cpu_cores = true;
+    config.show_network_stats = true;
+    config.show_process_group = true;
+    config.show_memory_detail = true;
+    Display display(config);
+
+    Result result;
+    std::vector<double> times;
+    times.reserve(static_cast<size_t>(rounds));
+    size_t allocated = 0;
+    for (int round = -1; round < rounds; ++round) {
+        size_t before = allocations;
+        auto start = Clock::now();
+        std::string_view frame = display.compose(stats);
+        auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        size_t frame_allocations = allocations - before;
+        if (round < 0) continue; // первый кадр растит буфер до нужного размера
+        times.push_back(elapsed);
+        allocated += frame_allocations;
+        result.bytes = frame.size();
+    }
+    result.us_per_frame = median(times);
+    result.allocs = static_cast<double>(allocated) / rounds;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int rounds = 200;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::fprintf(stderr, "Usage: %s [--rounds N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Display прячет и показывает курсор через std::cout - на время замеров
+    // поток без буфера молча отбрасывает вывод, таблица остаётся чистой
+    std::streambuf* terminal = std::cout.rdbuf(nullptr);
+    std::vector<Result> results;
+    for (int rows : ROW_COUNTS) {
+        SystemStats stats = makeStats(rows);
+        results.push_back(measure(true, rounds, stats));
+        results.push_back(measure(false, rounds, stats));
+    }
+    std::cout.rdbuf(terminal);
+
+    std::printf("%6s %-7s %12s %12s %13s\n", "rows", "colors", "us/frame", "bytes/frame", "allocs/frame");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        std::printf("%6d %-7s %12.1f %12zu %13.2f\n", ROW_COUNTS[i / 2], i % 2 == 0 ? "yes" : "no",
+                    result.us_per_frame, result.bytes, result.allocs);
+    }
+    return 0;
+}
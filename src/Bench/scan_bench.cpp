@@ -0,0 +1,142 @@
+// Compares the synchronous and io_uring paths of ProcStatReader on this host:
+// wall time and system calls per full scan of /proc/PID/stat.
+//
+//   mtop-scan-bench [--rounds N] [--spawn N]
+//
+// "cold" scans start with an empty descriptor cache (openat + read per
+// process), "warm" scans reuse the descriptors of the previous scan (one
+// read per process); "cached fds" is how many descriptors the reader keeps
+// open for the next scan. --spawn adds N sleeping child processes to make the
+// process table look like a busy host.
+#include "proc_stat.hpp"
+#include "proc_dir.hpp"
+#include "io_ring.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+struct Result {
+    double wall_ms = 0.0;      // медиана одного прохода
+    double syscalls = 0.0;     // в среднем за проход
+    size_t processes = 0;
+    size_t cached_fds = 0;     // дескрипторов осталось открыто после прохода
+};
+
+// Один проход так же, как его делает SystemInfo::scanShard
+size_t scan(ProcStatReader& reader, const std::vector<int>& pids) {
+    size_t parsed = 0;
+    reader.beginScan();
+    const bool batched = reader.usingRing();
+    for (size_t i = 0; i < pids.size(); ++i) {
+        if (batched && i % ProcStatReader::BATCH_SIZE == 0) {
+            reader.prefetch(&pids[i], std::min(ProcStatReader::BATCH_SIZE, pids.size() - i));
+        }
+        ProcStat stat;
+        if (reader.read(pids[i], stat)) parsed++;
+    }
+    reader.endScan();
+    return parsed;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+Result measure(bool uring, bool warm, int rounds, const std::vector<int>& pids) {
+    using Clock = std::chrono::steady_clock;
+    Result result;
+    std::vector<double> times;
+    uint64_t syscalls = 0;
+
+    std::unique_ptr<ProcStatReader> reader;
+    for (int round = -1; round < rounds; ++round) {
+        // Холодный проход - новый читатель без дескрипторов; тёплый - прогретый
+        if (!reader || !warm) {
+            reader = std::make_unique<ProcStatReader>();
+            reader->useRing(uring);
+        }
+        uint64_t before = reader->syscalls();
+        auto start = Clock::now();
+        size_t parsed = scan(*reader, pids);
+        auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (round < 0) continue; // первый проход только прогревает кэши ядра
+        times.push_back(elapsed);
+        syscalls += reader->syscalls() - before;
+        result.processes = parsed;
+        result.cached_fds = reader->cachedCount();
+    }
+    result.wall_ms = median(times);
+    result.syscalls = rounds > 0 ? static_cast<double>(syscalls) / rounds : 0.0;
+    return result;
+}
+
+void print(const char* backend, const char* mode, const Result& result) {
+    std::printf("%-7s %-5s %10zu %12.2f %14.0f %11zu\n", backend, mode, result.processes, result.wall_ms, result.syscalls,
+                result.cached_fds);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int rounds = 20;
+    int spawn = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--spawn") == 0 && i + 1 < argc) {
+            spawn = std::max(0, std::atoi(argv[++i]));
+        } else {
+            std::fprintf(stderr, "Usage: %s [--rounds N] [--spawn N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Спящие дети умирают вместе с бенчмарком
+    std::vector<pid_t> children;
+    for (int i = 0; i < spawn; ++i) {
+        pid_t child = fork();
+        if (child == 0) {
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+            for (;;) pause();
+        }
+        if (child < 0) {
+            std::fprintf(stderr, "fork failed after %d children: %s\n", i, std::strerror(errno));
+            break;
+        }
+        children.push_back(child);
+    }
+
+    PidEnumerator enumerator;
+    if (!enumerator.scan("/proc")) {
+        std::fprintf(stderr, "Cannot read /proc\n");
+        return 1;
+    }
+    const std::vector<int> pids = enumerator.ids();
+
+    std::printf("%-7s %-5s %10s %12s %14s %11s\n", "backend", "scan", "processes", "ms/scan", "syscalls/scan",
+                "cached fds");
+    print("sync", "cold", measure(false, false, rounds, pids));
+    print("sync", "warm", measure(false, true, rounds, pids));
+    if (IoRing::supported()) {
+        print("uring", "cold", measure(true, false, rounds, pids));
+        print("uring", "warm", measure(true, true, rounds, pids));
+    } else {
+        std::printf("uring   -     io_uring is not available on this kernel\n");
+    }
+
+    for (pid_t child : children) kill(child, SIGKILL);
+    for (pid_t child : children) waitpid(child, nullptr, 0);
+    return 0;
+}
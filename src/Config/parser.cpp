@@ -61,6 +61,8 @@ bool ConfigParser::saveConfig(const std::string& config_path) const {
     file << "show_load_avg = " << (config.show_load_avg ? "true" : "false") << "\n";
     file << "show_memory_bar = " << (config.show_memory_bar ? "true" : "false") << "\n";
     file << "show_cpu_bar = " << (config.show_cpu_bar ? "true" : "false") << "\n";
+    file << "show_cpu_cores = " << (config.show_cpu_cores ? "true" : "false") << "\n";
+    file << "show_sparklines = " << (config.show_sparklines ? "true" : "false") << "\n";
     file << "progress_bar_width = " << config.progress_bar_width << "\n";
     file << "theme = " << config.theme << "\n\n";
     
@@ -69,6 +71,10 @@ bool ConfigParser::saveConfig(const std::string& config_path) const {
     file << "reverse_sort = " << (config.reverse_sort ? "true" : "false") << "\n";
     file << "show_process_state = " << (config.show_process_state ? "true" : "false") << "\n";
     file << "show_process_user = " << (config.show_process_user ? "true" : "false") << "\n";
+    file << "show_process_group = " << (config.show_process_group ? "true" : "false") << "\n";
+    file << "show_command_line = " << (config.show_command_line ? "true" : "false") << "\n";
+    file << "show_threads = " << (config.show_threads ? "true" : "false") << "\n";
+    file << "show_memory_detail = " << (config.show_memory_detail ? "true" : "false") << "\n";
     file << "show_kernel_threads = " << (config.show_kernel_threads ? "true" : "false") << "\n";
     
     if (!config.hide_processes.empty()) {
@@ -89,6 +95,17 @@ bool ConfigParser::saveConfig(const std::string& config_path) const {
         file << "\n";
     }
     
+    if (!config.filter.empty()) {
+        file << "filter = " << config.filter << "\n";
+    }
+    
+    file << "\n[collector]\n";
+    file << "max_cached_fds = " << config.max_cached_fds << "\n";
+    file << "collector_threads = " << config.collector_threads << "\n";
+    file << "attach_shared = " << (config.attach_shared ? "true" : "false") << "\n";
+    file << "scan_backend = " << scanBackendToString(config.scan_backend) << "\n";
+    file << "smaps_budget_ms = " << config.smaps_budget_ms << "\n";
+    
     return true;
 }
 
@@ -104,6 +121,24 @@ bool ConfigParser::parseCommandLine(int argc, char* argv[]) {
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         
+        // Значение опции в виде "--name=value" или "--name value"
+        std::string value;
+        bool has_value = false;
+        auto option = [&](const char* name) {
+            std::string prefix = std::string(name) + "=";
+            if (arg.compare(0, prefix.size(), prefix) == 0) {
+                value = arg.substr(prefix.size());
+                has_value = true;
+                return true;
+            }
+            if (arg != name) return false;
+            if (i + 1 < argc) {
+                value = argv[++i];
+                has_value = true;
+            }
+            return true;
+        };
+        
         if (arg == "-h" || arg == "--help") {
             printHelp();
             return false;
@@ -116,7 +151,8 @@ bool ConfigParser::parseCommandLine(int argc, char* argv[]) {
             }
         } else if (arg == "-d" || arg == "--delay") {
             if (i + 1 < argc) {
-                config.update_interval = parseInt(argv[++i]);
+                // Те же пределы, что и для update_interval в файле настроек
+                config.update_interval = std::max(1, std::min(60, parseInt(argv[++i])));
             } else {
                 std::cerr << "Error: --delay requires a number\n";
                 return false;
@@ -140,6 +176,62 @@ bool ConfigParser::parseCommandLine(int argc, char* argv[]) {
             config.sort_by = MtopConfig::SortBy::NAME;
         } else if (arg == "--reverse") {
             config.reverse_sort = true;
+        } else if (arg == "--threads") {
+            config.show_threads = true;
+        } else if (arg == "--memory-detail") {
+            config.show_memory_detail = true;
+        } else if (option("--filter")) {
+            if (!has_value) {
+                std::cerr << "Error: --filter requires an expression\n";
+                return false;
+            }
+            config.filter = value;
+        } else if (arg == "--batch") {
+            config.batch_mode = true;
+        } else if (option("--format")) {
+            if (!has_value || !parseOutputFormat(value, config.output_format)) {
+                std::cerr << "Error: --format must be jsonl or csv\n";
+                return false;
+            }
+        } else if (option("--iterations")) {
+            if (!has_value) {
+                std::cerr << "Error: --iterations requires a number\n";
+                return false;
+            }
+            config.iterations = parseInt(value, 1000000000);
+        } else if (option("--interval")) {
+            config.interval_ms = has_value ? parseIntervalMs(value) : 0;
+            if (config.interval_ms == 0) {
+                std::cerr << "Error: --interval requires seconds between 0.01 and 3600\n";
+                return false;
+            }
+        } else if (option("--record")) {
+            if (!has_value || value.empty()) {
+                std::cerr << "Error: --record requires a file path\n";
+                return false;
+            }
+            config.record_file = value;
+        } else if (option("--replay")) {
+            if (!has_value || value.empty()) {
+                std::cerr << "Error: --replay requires a file path\n";
+                return false;
+            }
+            config.replay_file = value;
+        } else if (option("--serve")) {
+            if (!has_value || value.empty()) {
+                std::cerr << "Error: --serve requires an address, e.g. :9100 or 127.0.0.1:9100\n";
+                return false;
+            }
+            config.serve_address = value;
+        } else if (arg == "--publish") {
+            config.publish_shared = true;
+        } else if (arg == "--no-shared") {
+            config.attach_shared = false;
+        } else if (option("--scan-backend")) {
+            if (!has_value || !parseScanBackend(value, config.scan_backend)) {
+                std::cerr << "Error: --scan-backend must be auto, sync or uring\n";
+                return false;
+            }
         } else {
             std::cerr << "Warning: Unknown argument: " << arg << std::endl;
         }
@@ -154,14 +246,34 @@ void ConfigParser::printHelp() const {
     std::cout << "Options:\n";
     std::cout << "  -h, --help              Show this help message\n";
     std::cout << "  -c, --config FILE       Use specified configuration file\n";
-    std::cout << "  -d, --delay SECONDS     Update interval in seconds\n";
+    std::cout << "  -d, --delay SECONDS     Update interval in seconds (1-60)\n";
     std::cout << "  -n, --max-processes N   Maximum number of processes to show\n";
     std::cout << "  --no-color              Disable colored output\n";
     std::cout << "  --sort-memory           Sort processes by memory usage (default)\n";
     std::cout << "  --sort-cpu              Sort processes by CPU usage\n";
     std::cout << "  --sort-pid              Sort processes by PID\n";
     std::cout << "  --sort-name             Sort processes by name\n";
-    std::cout << "  --reverse               Reverse sort order\n\n";
+    std::cout << "  --reverse               Reverse sort order\n";
+    std::cout << "  --threads               List the threads of the top processes instead\n";
+    std::cout << "  --memory-detail         Add PSS, USS and swap columns (smaps_rollup)\n";
+    std::cout << "  --filter EXPR           Only list matching processes, e.g.\n";
+    std::cout << "                          'user in (web,db) && rss > 1G && name !~ /^kworker/'\n\n";
+    std::cout << "Batch mode:\n";
+    std::cout << "  --batch                 Print samples to stdout instead of the interactive view\n";
+    std::cout << "  --format FORMAT         Output format: jsonl (default) or csv\n";
+    std::cout << "  --iterations N          Stop after N samples (default: run until interrupted)\n";
+    std::cout << "  --interval SECONDS      Sample interval, fractions allowed (e.g. 0.5)\n\n";
+    std::cout << "Recording:\n";
+    std::cout << "  --record FILE           Append samples to a compact recording (headless)\n";
+    std::cout << "  --replay FILE           Browse a recording: space play/pause, ,/. step,\n";
+    std::cout << "                          [/] one minute, g/G first/last sample\n\n";
+    std::cout << "Exporter:\n";
+    std::cout << "  --serve ADDR            Serve OpenMetrics at http://ADDR/metrics (e.g. :9100)\n\n";
+    std::cout << "Shared collector:\n";
+    std::cout << "  --publish               Collect for every mtop on this host via shared memory\n";
+    std::cout << "  --no-shared             Scan /proc even if a --publish collector is running\n";
+    std::cout << "  --scan-backend MODE     Read /proc with plain syscalls (sync, default),\n";
+    std::cout << "                          io_uring batches (uring) or uring if available (auto)\n\n";
     std::cout << "Configuration files:\n";
     std::cout << "  ~/.config/mtop/config   User configuration\n";
     std::cout << "  /etc/mtop/config        System configuration\n\n";
@@ -234,6 +346,10 @@ bool ConfigParser::parseLine(const std::string& line) {
         config.show_memory_bar = parseBool(value);
     } else if (key == "show_cpu_bar") {
         config.show_cpu_bar = parseBool(value);
+    } else if (key == "show_cpu_cores") {
+        config.show_cpu_cores = parseBool(value);
+    } else if (key == "show_sparklines") {
+        config.show_sparklines = parseBool(value);
     } else if (key == "show_network_stats") {
         config.show_network_stats = parseBool(value);
     } else if (key == "theme") {
@@ -246,8 +362,26 @@ bool ConfigParser::parseLine(const std::string& line) {
         config.show_process_state = parseBool(value);
     } else if (key == "show_process_user") {
         config.show_process_user = parseBool(value);
+    } else if (key == "show_process_group") {
+        config.show_process_group = parseBool(value);
+    } else if (key == "show_command_line") {
+        config.show_command_line = parseBool(value);
+    } else if (key == "show_threads") {
+        config.show_threads = parseBool(value);
+    } else if (key == "show_memory_detail") {
+        config.show_memory_detail = parseBool(value);
     } else if (key == "show_kernel_threads") {
         config.show_kernel_threads = parseBool(value);
+    } else if (key == "max_cached_fds") {
+        config.max_cached_fds = parseInt(value, 1 << 20); // 0 = по RLIMIT_NOFILE
+    } else if (key == "collector_threads") {
+        config.collector_threads = parseInt(value, 256); // 0 = по числу CPU
+    } else if (key == "attach_shared") {
+        config.attach_shared = parseBool(value);
+    } else if (key == "scan_backend") {
+        parseScanBackend(value, config.scan_backend);
+    } else if (key == "smaps_budget_ms") {
+        config.smaps_budget_ms = parseInt(value, 10000);
     } else if (key == "hide_processes") {
         config.hide_processes = split(value, ',');
         // Trim each process name
@@ -260,6 +394,8 @@ bool ConfigParser::parseLine(const std::string& line) {
         for (auto& user : config.show_only_users) {
             user = trim(user);
         }
+    } else if (key == "filter") {
+        config.filter = value;
     } else {
         return false; // Unknown key
     }
@@ -294,12 +430,12 @@ bool ConfigParser::parseBool(const std::string& value) const {
     return lower_value == "true" || lower_value == "yes" || lower_value == "1" || lower_value == "on";
 }
 
-int ConfigParser::parseInt(const std::string& value) const {
+int ConfigParser::parseInt(const std::string& value, int max_value) const {
     try {
         int result = std::stoi(value);
         // Валидация разумных пределов
         if (result < 0) return 0;
-        if (result > 3600) return 3600; // Максимум 1 час
+        if (result > max_value) return max_value;
         return result;
     } catch (const std::exception&) {
         return 0;
@@ -317,6 +453,61 @@ MtopConfig::SortBy ConfigParser::parseSortBy(const std::string& value) const {
     return MtopConfig::SortBy::MEMORY; // Default
 }
 
+bool ConfigParser::parseOutputFormat(const std::string& value, MtopConfig::OutputFormat& format) const {
+    std::string lower_value = value;
+    std::transform(lower_value.begin(), lower_value.end(), lower_value.begin(), ::tolower);
+    
+    if (lower_value == "jsonl" || lower_value == "json") {
+        format = MtopConfig::OutputFormat::JSONL;
+        return true;
+    }
+    if (lower_value == "csv") {
+        format = MtopConfig::OutputFormat::CSV;
+        return true;
+    }
+    return false;
+}
+
+bool ConfigParser::parseScanBackend(const std::string& value, MtopConfig::ScanBackend& backend) const {
+    std::string lower_value = value;
+    std::transform(lower_value.begin(), lower_value.end(), lower_value.begin(), ::tolower);
+    
+    if (lower_value == "auto") {
+        backend = MtopConfig::ScanBackend::AUTO;
+        return true;
+    }
+    if (lower_value == "sync") {
+        backend = MtopConfig::ScanBackend::SYNC;
+        return true;
+    }
+    if (lower_value == "uring" || lower_value == "io_uring") {
+        backend = MtopConfig::ScanBackend::URING;
+        return true;
+    }
+    return false;
+}
+
+std::string ConfigParser::scanBackendToString(MtopConfig::ScanBackend backend) const {
+    switch (backend) {
+        case MtopConfig::ScanBackend::SYNC: return "sync";
+        case MtopConfig::ScanBackend::URING: return "uring";
+        case MtopConfig::ScanBackend::AUTO: return "auto";
+    }
+    return "auto";
+}
+
+int ConfigParser::parseIntervalMs(const std::string& value) const {
+    try {
+        size_t used = 0;
+        double seconds = std::stod(value, &used);
+        // Интервал короче 10 мс не имеет смысла для /proc
+        if (used != value.size() || !(seconds >= 0.01) || seconds > 3600.0) return 0;
+        return static_cast<int>(seconds * 1000.0 + 0.5);
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
 std::string ConfigParser::sortByToString(MtopConfig::SortBy sort_by) const {
     switch (sort_by) {
         case MtopConfig::SortBy::CPU: return "cpu";
@@ -13,6 +13,8 @@ struct MtopConfig {
     bool show_load_avg = true;
     bool show_memory_bar = true;
     bool show_cpu_bar = true;
+    bool show_cpu_cores = true;
+    bool show_sparklines = true;
     bool show_network_stats = true;
     
     // Process settings
@@ -30,11 +32,46 @@ struct MtopConfig {
     int progress_bar_width = 30;
     bool show_process_state = true;
     bool show_process_user = true;
+    bool show_process_group = false;
+    bool show_command_line = false; // full cmdline column next to the 15-character name
+    bool show_threads = false;     // threads of the listed processes instead of processes
+    bool show_memory_detail = false; // PSS, USS and swap from smaps_rollup
     
     // Filtering
     std::vector<std::string> hide_processes;
     std::vector<std::string> show_only_users;
     bool show_kernel_threads = false;
+    std::string filter; // filter expression, see ProcessFilter
+    
+    // Collector settings
+    int max_cached_fds = 0; // 0 = derive from RLIMIT_NOFILE
+    int collector_threads = 1; // 0 = one per online CPU
+    bool attach_shared = true; // use a running --publish collector instead of scanning /proc
+    enum class ScanBackend {
+        AUTO,  // io_uring when the kernel has it, plain syscalls otherwise
+        SYNC,
+        URING
+    };
+    ScanBackend scan_backend = ScanBackend::SYNC;
+    int smaps_budget_ms = 20; // time per tick for smaps_rollup reads
+    
+    // Batch mode (command line only)
+    enum class OutputFormat {
+        JSONL,
+        CSV
+    };
+    bool batch_mode = false;
+    OutputFormat output_format = OutputFormat::JSONL;
+    int iterations = 0; // 0 = run until interrupted
+    int interval_ms = 0; // 0 = update_interval seconds
+    
+    // Recording (command line only)
+    std::string record_file; // append samples here instead of printing them
+    std::string replay_file; // browse a recording instead of the live system
+    
+    // Exporter (command line only)
+    std::string serve_address; // serve OpenMetrics on this address instead of the UI
+    bool publish_shared = false; // collect into shared memory for other mtop instances
 };
 
 class ConfigParser {
@@ -81,8 +118,12 @@ private:
     
     // Value parsing
     bool parseBool(const std::string& value) const;
-    int parseInt(const std::string& value) const;
+    int parseInt(const std::string& value, int max_value = 3600) const;
     MtopConfig::SortBy parseSortBy(const std::string& value) const;
+    bool parseOutputFormat(const std::string& value, MtopConfig::OutputFormat& format) const;
+    int parseIntervalMs(const std::string& value) const;
+    bool parseScanBackend(const std::string& value, MtopConfig::ScanBackend& backend) const;
+    std::string scanBackendToString(MtopConfig::ScanBackend backend) const;
     std::string sortByToString(MtopConfig::SortBy sort_by) const;
 };
 
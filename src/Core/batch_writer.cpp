@@ -0,0 +1,257 @@
+#include "batch_writer.hpp"
+#include <charconv>
+#include <ctime>
+#include <initializer_list>
+
+namespace {
+
+// Те же поля, что и в JSON Lines; выключенные настройками остаются пустыми
+constexpr std::string_view CSV_HEADER =
+    "time,sample,type,pid,tgid,name,command,state,uid,user,gid,group,"
+    "cpu_percent,cpu_user_percent,cpu_system_percent,memory_kb,pss_kb,uss_kb,swap_kb,load1,load5,load15\n";
+
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+} // namespace
+
+BatchWriter::BatchWriter(const MtopConfig& cfg, int out_fd)
+    : config(cfg), fd(out_fd), buffer(65536), header_written(false), samples(0), timestamp_length(0) {
+}
+
+bool BatchWriter::write(const Snapshot& snapshot) {
+    buffer.clear();
+    ++samples;
+    formatTimestamp();
+    if (config.output_format == MtopConfig::OutputFormat::CSV) {
+        writeCsv(snapshot);
+    } else {
+        writeJson(snapshot);
+    }
+    return buffer.writeTo(fd);
+}
+
+void BatchWriter::writeJson(const Snapshot& snapshot) {
+    const SystemStats& stats = snapshot.stats;
+
+    buffer.append("{\"time\":");
+    buffer.append(timestamp, timestamp_length);
+    buffer.append(",\"sample\":");
+    buffer.appendUnsigned(samples);
+    buffer.append(",\"cpu_percent\":");
+    buffer.appendFixed(stats.cpu_percent, 1);
+
+    if (!stats.cpu_cores.empty()) {
+        buffer.append(",\"cpu_cores\":[");
+        for (size_t i = 0; i < stats.cpu_cores.size(); ++i) {
+            if (i > 0) buffer.append(',');
+            buffer.appendFixed(stats.cpu_cores[i].total, 1);
+        }
+        buffer.append(']');
+    }
+
+    buffer.append(",\"memory\":{\"total_kb\":");
+    buffer.appendUnsigned(stats.total_memory_kb);
+    buffer.append(",\"used_kb\":");
+    buffer.appendUnsigned(stats.used_memory_kb);
+    buffer.append(",\"free_kb\":");
+    buffer.appendUnsigned(stats.free_memory_kb);
+    buffer.append("},\"load\":[");
+    for (int i = 0; i < 3; ++i) {
+        if (i > 0) buffer.append(',');
+        buffer.appendFixed(stats.load_avg[i], 2);
+    }
+    buffer.append("],\"process_count\":");
+    buffer.appendInt(stats.process_count);
+
+    if (config.show_network_stats) {
+        buffer.append(",\"network\":[");
+        for (size_t i = 0; i < stats.network_interfaces.size(); ++i) {
+            const auto& net = stats.network_interfaces[i];
+            if (i > 0) buffer.append(',');
+            buffer.append("{\"interface\":");
+            appendJsonString(net.interface);
+            buffer.append(",\"rx_bytes\":");
+            buffer.appendUnsigned(net.rx_bytes);
+            buffer.append(",\"tx_bytes\":");
+            buffer.appendUnsigned(net.tx_bytes);
+            buffer.append(",\"rx_packets\":");
+            buffer.appendUnsigned(net.rx_packets);
+            buffer.append(",\"tx_packets\":");
+            buffer.appendUnsigned(net.tx_packets);
+            buffer.append('}');
+        }
+        buffer.append(']');
+    }
+
+    buffer.append(",\"processes\":[");
+    for (size_t i = 0; i < stats.processes.size(); ++i) {
+        const auto& proc = stats.processes[i];
+        if (i > 0) buffer.append(',');
+        buffer.append("{\"pid\":");
+        buffer.appendInt(proc.pid);
+        if (config.show_threads) {
+            buffer.append(",\"tgid\":");
+            buffer.appendInt(proc.tgid);
+        }
+        buffer.append(",\"name\":");
+        appendJsonString(proc.name);
+        if (config.show_command_line) {
+            buffer.append(",\"command\":");
+            appendJsonString(proc.command);
+        }
+        buffer.append(",\"state\":");
+        appendJsonString(proc.state);
+        buffer.append(",\"uid\":");
+        buffer.appendInt(proc.uid);
+        buffer.append(",\"user\":");
+        appendJsonString(proc.user);
+        if (config.show_process_group) {
+            buffer.append(",\"gid\":");
+            buffer.appendInt(proc.gid);
+            buffer.append(",\"group\":");
+            appendJsonString(proc.group);
+        }
+        buffer.append(",\"cpu_percent\":");
+        buffer.appendFixed(proc.cpu_percent, 1);
+        buffer.append(",\"cpu_user_percent\":");
+        buffer.appendFixed(proc.cpu_user_percent, 1);
+        buffer.append(",\"cpu_system_percent\":");
+        buffer.appendFixed(proc.cpu_system_percent, 1);
+        buffer.append(",\"memory_kb\":");
+        buffer.appendUnsigned(proc.memory_kb);
+        if (config.show_memory_detail) {
+            // null, пока smaps_rollup процесса не прочитан (или недоступен)
+            auto detail = [&](uint64_t kb) {
+                if (proc.memory_detail) buffer.appendUnsigned(kb);
+                else buffer.append("null");
+            };
+            buffer.append(",\"pss_kb\":");
+            detail(proc.pss_kb);
+            buffer.append(",\"uss_kb\":");
+            detail(proc.uss_kb);
+            buffer.append(",\"swap_kb\":");
+            detail(proc.swap_kb);
+        }
+        buffer.append('}');
+    }
+    buffer.append("]}\n");
+}
+
+void BatchWriter::writeCsv(const Snapshot& snapshot) {
+    const SystemStats& stats = snapshot.stats;
+
+    if (!header_written) {
+        buffer.append(CSV_HEADER);
+        header_written = true;
+    }
+
+    // Строка системы: CPU и используемая память всей машины
+    buffer.append(timestamp, timestamp_length);
+    buffer.append(',');
+    buffer.appendUnsigned(samples);
+    buffer.append(",system,,,,,,,,,,");
+    buffer.appendFixed(stats.cpu_percent, 1);
+    buffer.append(",,,");
+    buffer.appendUnsigned(stats.used_memory_kb);
+    buffer.append(",,,");
+    for (int i = 0; i < 3; ++i) {
+        buffer.append(',');
+        buffer.appendFixed(stats.load_avg[i], 2);
+    }
+    buffer.append('\n');
+
+    for (const auto& proc : stats.processes) {
+        buffer.append(timestamp, timestamp_length);
+        buffer.append(',');
+        buffer.appendUnsigned(samples);
+        buffer.append(",process,");
+        buffer.appendInt(proc.pid);
+        buffer.append(',');
+        if (config.show_threads) buffer.appendInt(proc.tgid);
+        buffer.append(',');
+        appendCsvField(proc.name);
+        buffer.append(',');
+        if (config.show_command_line) appendCsvField(proc.command);
+        buffer.append(',');
+        appendCsvField(proc.state);
+        buffer.append(',');
+        buffer.appendInt(proc.uid);
+        buffer.append(',');
+        appendCsvField(proc.user);
+        buffer.append(',');
+        if (config.show_process_group) {
+            buffer.appendInt(proc.gid);
+            buffer.append(',');
+            appendCsvField(proc.group);
+        } else {
+            buffer.append(',');
+        }
+        buffer.append(',');
+        buffer.appendFixed(proc.cpu_percent, 1);
+        buffer.append(',');
+        buffer.appendFixed(proc.cpu_user_percent, 1);
+        buffer.append(',');
+        buffer.appendFixed(proc.cpu_system_percent, 1);
+        buffer.append(',');
+        buffer.appendUnsigned(proc.memory_kb);
+        for (uint64_t kb : {proc.pss_kb, proc.uss_kb, proc.swap_kb}) {
+            // Пусто, пока smaps_rollup процесса не прочитан - как null в JSON
+            buffer.append(',');
+            if (config.show_memory_detail && proc.memory_detail) buffer.appendUnsigned(kb);
+        }
+        buffer.append(",,,\n");
+    }
+}
+
+void BatchWriter::formatTimestamp() {
+    // Unix-время с миллисекундами, одно на всю выборку
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    int millis = static_cast<int>(now.tv_nsec / 1000000);
+
+    auto result = std::to_chars(timestamp, timestamp + sizeof(timestamp) - 4, static_cast<int64_t>(now.tv_sec));
+    char* p = result.ptr;
+    *p++ = '.';
+    *p++ = static_cast<char>('0' + millis / 100);
+    *p++ = static_cast<char>('0' + millis / 10 % 10);
+    *p++ = static_cast<char>('0' + millis % 10);
+    timestamp_length = static_cast<size_t>(p - timestamp);
+}
+
+void BatchWriter::appendJsonString(std::string_view text) {
+    buffer.append('"');
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        // Копируем безопасный участок целиком и экранируем символ
+        buffer.append(text.substr(start, i - start));
+        if (c == '"' || c == '\\') {
+            buffer.append('\\');
+            buffer.append(static_cast<char>(c));
+        } else {
+            buffer.append("\\u00");
+            buffer.append(HEX_DIGITS[c >> 4]);
+            buffer.append(HEX_DIGITS[c & 0x0f]);
+        }
+        start = i + 1;
+    }
+    buffer.append(text.substr(start));
+    buffer.append('"');
+}
+
+void BatchWriter::appendCsvField(std::string_view text) {
+    // Кавычки нужны только если в поле есть разделитель, кавычка или перевод строки
+    if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+        buffer.append(text);
+        return;
+    }
+
+    buffer.append('"');
+    for (char c : text) {
+        if (c == '"') buffer.append('"');
+        buffer.append(c);
+    }
+    buffer.append('"');
+}
@@ -0,0 +1,37 @@
+#ifndef BATCH_WRITER_HPP
+#define BATCH_WRITER_HPP
+
+#include <cstdint>
+#include <string_view>
+#include "system_info.hpp"
+#include "frame_buffer.hpp"
+#include "parser.hpp"
+
+// Streams samples for --batch as JSON Lines (one object per sample) or CSV
+// (one "system" row plus one "process" row per listed process).
+// Each sample is formatted into a reused FrameBuffer and written with a
+// single write(), so a log pipeline never sees half a record.
+class BatchWriter {
+public:
+    BatchWriter(const MtopConfig& config, int fd);
+
+    // Format and write one sample; false if the output is gone
+    bool write(const Snapshot& snapshot);
+
+private:
+    MtopConfig config;
+    int fd;
+    FrameBuffer buffer;
+    bool header_written;
+    uint64_t samples;
+    char timestamp[32];
+    size_t timestamp_length;
+
+    void writeJson(const Snapshot& snapshot);
+    void writeCsv(const Snapshot& snapshot);
+    void formatTimestamp();
+    void appendJsonString(std::string_view text);
+    void appendCsvField(std::string_view text);
+};
+
+#endif // BATCH_WRITER_HPP
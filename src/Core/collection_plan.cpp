@@ -0,0 +1,48 @@
+#include "collection_plan.hpp"
+
+namespace {
+
+// Откуда берётся каждое поле
+ProcSource sourceOf(ProcField field) {
+    switch (field) {
+        case ProcField::USER:
+        case ProcField::GROUP:
+            return ProcSource::OWNER;
+        case ProcField::COMMAND:
+            return ProcSource::CMDLINE;
+        case ProcField::MEMORY_DETAIL:
+            return ProcSource::SMAPS;
+        default:
+            return ProcSource::STAT;
+    }
+}
+
+} // namespace
+
+CollectionPlan CollectionPlan::fromConfig(const MtopConfig& config) {
+    CollectionPlan plan;
+
+    // Всегда видимые колонки
+    plan.require(ProcField::NAME);
+    plan.require(ProcField::MEMORY);
+
+    if (config.show_process_state) plan.require(ProcField::STATE);
+    if (config.show_process_user) plan.require(ProcField::USER);
+    if (config.show_process_group) plan.require(ProcField::GROUP);
+    if (config.show_command_line) plan.require(ProcField::COMMAND);
+    if (config.show_memory_detail) plan.require(ProcField::MEMORY_DETAIL);
+
+    // Ключ сортировки
+    if (config.sort_by == MtopConfig::SortBy::CPU) plan.require(ProcField::CPU);
+
+    // Фильтры
+    if (!config.show_kernel_threads) plan.require(ProcField::KERNEL_FLAG);
+    if (!config.show_only_users.empty()) plan.require(ProcField::USER);
+
+    return plan;
+}
+
+void CollectionPlan::require(ProcField field) {
+    fields |= static_cast<uint32_t>(field);
+    sources |= static_cast<uint32_t>(sourceOf(field));
+}
@@ -0,0 +1,47 @@
+#ifndef COLLECTION_PLAN_HPP
+#define COLLECTION_PLAN_HPP
+
+#include <cstdint>
+#include "parser.hpp"
+
+// Per-process fields the current view may need
+enum class ProcField : uint32_t {
+    NAME = 1u << 0,
+    STATE = 1u << 1,
+    MEMORY = 1u << 2,
+    CPU = 1u << 3,
+    USER = 1u << 4,
+    GROUP = 1u << 5,
+    KERNEL_FLAG = 1u << 6,
+    COMMAND = 1u << 7,
+    MEMORY_DETAIL = 1u << 8, // PSS, USS, swap
+};
+
+// Places those fields come from, in increasing order of cost
+enum class ProcSource : uint32_t {
+    STAT = 1u << 0,  // /proc/PID/stat
+    OWNER = 1u << 1, // fstat() on the stat descriptor: uid/gid of the task
+    CMDLINE = 1u << 2, // /proc/PID/cmdline, read only for listed processes
+    SMAPS = 1u << 3,   // /proc/PID/smaps_rollup, under a per-tick time budget
+};
+
+// Decides which /proc sources a refresh has to touch.
+// Derived from visible columns, the sort key and active filters, so that
+// the cost of a scan follows what is actually displayed.
+class CollectionPlan {
+public:
+    CollectionPlan() : fields(0), sources(0) {}
+
+    static CollectionPlan fromConfig(const MtopConfig& config);
+
+    bool needs(ProcField field) const { return (fields & static_cast<uint32_t>(field)) != 0; }
+    bool reads(ProcSource source) const { return (sources & static_cast<uint32_t>(source)) != 0; }
+
+private:
+    uint32_t fields;
+    uint32_t sources;
+
+    void require(ProcField field);
+};
+
+#endif // COLLECTION_PLAN_HPP
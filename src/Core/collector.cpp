@@ -0,0 +1,133 @@
+#include "collector.hpp"
+#include <cstdint>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+Collector::Collector(const MtopConfig& cfg)
+    : shared_sequence(0), shared_pid(0), event_fd(-1), config(cfg), config_changed(false), wake_requested(false),
+      stopping(false) {
+    event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    // Если на хосте работает mtop --publish, /proc не сканируем вовсе
+    if (cfg.attach_shared && shared.attach(SharedPublisher::DEFAULT_NAME)) {
+        shared_pid = shared.publisherPid();
+        std::string error;
+        shared_filter.compile(cfg, shared_identities, error);
+    }
+    publish(collect(cfg, false));
+    thread = std::thread(&Collector::run, this);
+}
+
+Collector::~Collector() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake_cv.notify_one();
+    thread.join();
+
+    if (event_fd >= 0) {
+        close(event_fd);
+    }
+}
+
+void Collector::updateConfig(const MtopConfig& new_config) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        config = new_config;
+        config_changed = true;
+        wake_requested = true;
+    }
+    wake_cv.notify_one();
+}
+
+void Collector::requestUpdate() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake_requested = true;
+    }
+    wake_cv.notify_one();
+}
+
+bool Collector::poll(SnapshotPtr& snapshot) {
+    // Сбрасываем счётчик eventfd и забираем самый свежий снимок
+    uint64_t counter;
+    if (event_fd >= 0) {
+        ssize_t ignored = read(event_fd, &counter, sizeof(counter));
+        (void)ignored;
+    }
+
+    return channel.take(snapshot);
+}
+
+void Collector::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stopping) {
+        wake_cv.wait(lock, [this] { return stopping || wake_requested; });
+        if (stopping) break;
+        wake_requested = false;
+
+        bool apply_config = config_changed;
+        MtopConfig next_config = config;
+        config_changed = false;
+
+        // Сбор идёт без блокировки, чтобы UI мог менять настройки в любой момент
+        lock.unlock();
+        publish(collect(next_config, apply_config));
+        lock.lock();
+    }
+}
+
+SnapshotPtr Collector::collect(const MtopConfig& cfg, bool apply_config) {
+    if (shared.attached()) {
+        if (shared.live()) {
+            // Фильтры и сортировка зрителя применяются к копии из сегмента
+            bool accounts_changed = shared_identities.refresh();
+            if (apply_config || accounts_changed) {
+                std::string error;
+                shared_filter.compile(cfg, shared_identities, error);
+            }
+            std::shared_ptr<Snapshot> next = shared_snapshots.acquire();
+            if (!shared.read(cfg, shared_filter, next->stats)) return nullptr;
+            if (cfg.show_memory_detail) {
+                // Публикатор smaps_rollup не читает: зритель тратит бюджет на свои строки
+                shared_smaps.beginTick(static_cast<int64_t>(cfg.smaps_budget_ms) * 1000);
+                shared_smaps.sampleListed(next->stats.processes);
+                shared_smaps.endTick();
+            }
+            if (cfg.show_threads) {
+                shared_threads.expand(cfg, next->stats.processes);
+            }
+            next->sequence = ++shared_sequence;
+            return next;
+        }
+
+        // Публикатор завершился или завис - дальше сканируем сами
+        shared.detach();
+        shared_pid = 0;
+    }
+
+    if (!info) {
+        // Конструктор SystemInfo сразу делает первый сбор
+        info = std::make_unique<SystemInfo>(cfg);
+        return info->getSnapshot();
+    }
+    if (apply_config) {
+        info->updateConfig(cfg);
+    }
+    info->updateStats();
+    return info->getSnapshot();
+}
+
+void Collector::publish(SnapshotPtr snapshot) {
+    // Если UI не успел забрать прошлый снимок, новый его заменяет
+    if (!snapshot) return;
+    channel.publish(std::move(snapshot));
+
+    if (event_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(event_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef COLLECTOR_HPP
+#define COLLECTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "parser.hpp"
+#include "latest_value.hpp"
+#include "system_info.hpp"
+#include "shared_snapshot.hpp"
+
+// Runs SystemInfo on its own thread and hands finished snapshots to the UI
+// thread through a lock-free latest-value slot: a sample the UI has not
+// picked up yet is replaced by the newer one. A slow /proc scan therefore
+// never delays key handling or redraws.
+// Samples are taken on request; the owner decides the schedule.
+// When a --publish collector is running on the host, samples are copied
+// from its shared segment instead of scanning /proc; if that publisher
+// goes away the collector falls back to its own SystemInfo.
+class Collector {
+public:
+    explicit Collector(const MtopConfig& config);
+    ~Collector();
+
+    Collector(const Collector&) = delete;
+    Collector& operator=(const Collector&) = delete;
+
+    // Apply a new configuration and take a fresh sample right away
+    void updateConfig(const MtopConfig& new_config);
+
+    // Take a sample as soon as the collector thread is free
+    void requestUpdate();
+
+    // Newest snapshot published since the last call; false if there is none
+    bool poll(SnapshotPtr& snapshot);
+
+    // eventfd that becomes readable whenever a snapshot is published
+    int notifyFd() const { return event_fd; }
+
+    // PID of the shared publisher samples come from, 0 when scanning locally
+    int sharedPublisher() const { return shared_pid.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<SystemInfo> info; // created on first local scan
+    SharedReader shared;
+    ProcessFilter shared_filter; // SystemInfo compiles its own
+    IdentityCache shared_identities;
+    ThreadSampler shared_threads; // and expands its own threads
+    SmapsSampler shared_smaps;    // smaps_rollup of the listed rows only
+    SnapshotPool shared_snapshots;
+    uint64_t shared_sequence;
+    std::atomic<int> shared_pid;
+    LatestValue<SnapshotPtr> channel;
+    int event_fd;
+
+    std::mutex mutex;
+    std::condition_variable wake_cv;
+    MtopConfig config;
+    bool config_changed;
+    bool wake_requested;
+    bool stopping;
+    std::thread thread;
+
+    void run();
+    SnapshotPtr collect(const MtopConfig& config, bool apply_config);
+    void publish(SnapshotPtr snapshot);
+};
+
+#endif // COLLECTOR_HPP
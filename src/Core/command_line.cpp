@@ -0,0 +1,84 @@
+#include "command_line.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// Сколько тиков держим командную строку процесса, который ушёл из списка:
+// смена сортировки или фильтра не должна перечитывать всё заново
+constexpr uint64_t KEEP_TICKS = 30;
+
+// Как часто перечитываем строку показываемого процесса: setproctitle()
+// меняет её без exec(). Пустую (ядро или процесс посреди exec) - чаще
+constexpr uint64_t REFRESH_TICKS = KEEP_TICKS;
+constexpr uint64_t EMPTY_REFRESH_TICKS = 3;
+
+} // namespace
+
+bool readCommandLine(int pid, std::string& out) {
+    out.clear();
+
+    char path[32];
+    std::snprintf(path, sizeof(path), "/proc/%d/cmdline", pid);
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    // Больше, чем помещается в колонку, не нужно - читаем только начало
+    char buffer[CommandLineCache::MAX_LENGTH];
+    size_t length = 0;
+    while (length < sizeof(buffer)) {
+        ssize_t n = ::read(fd, buffer + length, sizeof(buffer) - length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        length += static_cast<size_t>(n);
+    }
+    ::close(fd);
+
+    // Аргументы разделены NUL; хвостовые разделители отбрасываем.
+    // Управляющие символы в аргументах не должны попасть в терминал
+    while (length > 0 && buffer[length - 1] == '\0') --length;
+    out.assign(buffer, length);
+    for (char& c : out) {
+        if (c == '\0') c = ' ';
+        else if (static_cast<unsigned char>(c) < 0x20 || c == 0x7f) c = '?';
+    }
+    return true;
+}
+
+const std::string& CommandLineCache::get(int pid, uint64_t start_time, std::string_view name) {
+    auto it = entries.find(pid);
+    if (it != entries.end() && it->second.start_time == start_time && it->second.name == name) {
+        Entry& entry = it->second;
+        entry.last_used = tick;
+        uint64_t refresh = entry.command.empty() ? EMPTY_REFRESH_TICKS : REFRESH_TICKS;
+        if (tick - entry.last_read >= refresh) {
+            entry.last_read = tick;
+            readCommandLine(pid, entry.command);
+        }
+        return entry.command;
+    }
+
+    // Новый процесс, переиспользованный PID или exec() - читаем заново
+    Entry& entry = entries[pid];
+    entry.start_time = start_time;
+    entry.last_used = tick;
+    entry.last_read = tick;
+    entry.name.assign(name);
+    readCommandLine(pid, entry.command);
+    return entry.command;
+}
+
+void CommandLineCache::endTick() {
+    ++tick;
+    if (tick % KEEP_TICKS != 0) return;
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (tick - it->second.last_used > KEEP_TICKS) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
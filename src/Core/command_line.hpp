@@ -0,0 +1,49 @@
+#ifndef COMMAND_LINE_HPP
+#define COMMAND_LINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Read /proc/PID/cmdline with the NUL separators turned into spaces.
+// Kernel threads and zombies have none; out is then empty.
+bool readCommandLine(int pid, std::string& out);
+
+// Full command lines of the listed processes.
+// Only rows that are actually shown ask for one. The file is read the first
+// time a process is listed and again every so often while the same
+// (pid, start_time) stays alive, because setproctitle() (postgres, nginx,
+// sshd) rewrites it in place. An empty line, e.g. one caught mid-exec, is
+// retried sooner. A changed name means the process called exec(), which
+// also replaces its command line, so that re-reads at once.
+class CommandLineCache {
+public:
+    CommandLineCache() : tick(0) {}
+
+    // Command line of a listed process; empty if it has none
+    const std::string& get(int pid, uint64_t start_time, std::string_view name);
+
+    // Forget processes that have not been listed for a while
+    void endTick();
+
+    size_t size() const { return entries.size(); }
+
+    // Longest command line kept; the table never shows more
+    static constexpr size_t MAX_LENGTH = 4096;
+
+private:
+    struct Entry {
+        uint64_t start_time;
+        uint64_t last_used;
+        uint64_t last_read;
+        std::string name;
+        std::string command;
+    };
+
+    std::unordered_map<int, Entry> entries;
+    uint64_t tick;
+};
+
+#endif // COMMAND_LINE_HPP
@@ -0,0 +1,91 @@
+#include "counter_table.hpp"
+#include <algorithm>
+
+namespace {
+
+constexpr size_t MIN_CAPACITY = 256;
+
+inline uint64_t mixKey(int pid, uint64_t start_time) {
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(pid)) << 32) ^ start_time;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return key;
+}
+
+} // namespace
+
+CounterTable::CounterTable() : slots(MIN_CAPACITY, Slot{0, {0, 0, 0}, 0, 0}), generation(1), used(0) {
+}
+
+void CounterTable::reset(size_t expected) {
+    used = 0;
+
+    // Держим заполнение не выше половины, иначе пробы удлиняются
+    size_t needed = std::max(MIN_CAPACITY, expected * 2);
+    if (slots.size() < needed) {
+        size_t capacity = slots.size();
+        while (capacity < needed) capacity *= 2;
+        slots.assign(capacity, Slot{0, {0, 0, 0}, 0, 0});
+        generation = 1;
+        return;
+    }
+
+    // Новое поколение делает все старые слоты пустыми
+    if (++generation == 0) {
+        std::fill(slots.begin(), slots.end(), Slot{0, {0, 0, 0}, 0, 0});
+        generation = 1;
+    }
+}
+
+void CounterTable::insert(int pid, uint64_t start_time, const ProcessCounters& counters) {
+    if ((used + 1) * 2 > slots.size()) {
+        rehash(slots.size() * 2);
+    }
+
+    size_t mask = slots.size() - 1;
+    for (size_t i = slotFor(pid, start_time);; i = (i + 1) & mask) {
+        Slot& slot = slots[i];
+        if (slot.generation != generation) {
+            slot = Slot{start_time, counters, pid, generation};
+            ++used;
+            return;
+        }
+        if (slot.pid == pid && slot.start_time == start_time) {
+            slot.counters = counters;
+            return;
+        }
+    }
+}
+
+const ProcessCounters* CounterTable::find(int pid, uint64_t start_time) const {
+    size_t mask = slots.size() - 1;
+    for (size_t i = slotFor(pid, start_time);; i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.generation != generation) return nullptr;
+        if (slot.pid == pid && slot.start_time == start_time) return &slot.counters;
+    }
+}
+
+size_t CounterTable::slotFor(int pid, uint64_t start_time) const {
+    return static_cast<size_t>(mixKey(pid, start_time)) & (slots.size() - 1);
+}
+
+void CounterTable::rehash(size_t capacity) {
+    std::vector<Slot> old(capacity, Slot{0, {0, 0, 0}, 0, 0});
+    old.swap(slots);
+
+    uint32_t old_generation = generation;
+    generation = 1;
+    used = 0;
+    for (const auto& slot : old) {
+        if (slot.generation == old_generation) {
+            insert(slot.pid, slot.start_time, slot.counters);
+        }
+    }
+}
+
+void CounterHistory::beginTick(size_t expected) {
+    current_index ^= 1;
+    tables[current_index].reset(expected);
+}
@@ -0,0 +1,70 @@
+#ifndef COUNTER_TABLE_HPP
+#define COUNTER_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU counters of one process at one sample, and the row that sample
+// occupies in the scan's ProcessTable
+struct ProcessCounters {
+    uint64_t utime;
+    uint64_t stime;
+    uint32_t row;
+};
+
+// Open-addressing map (pid, start_time) -> ProcessCounters.
+// Slots carry a generation stamp, so starting a new generation empties the
+// table without touching memory; keying on start_time keeps a recycled PID
+// from inheriting the counters of the process that used it before.
+class CounterTable {
+public:
+    CounterTable();
+
+    // Start a new, empty generation sized for roughly `expected` entries
+    void reset(size_t expected);
+
+    void insert(int pid, uint64_t start_time, const ProcessCounters& counters);
+    const ProcessCounters* find(int pid, uint64_t start_time) const;
+
+    size_t size() const { return used; }
+
+private:
+    struct Slot {
+        uint64_t start_time;
+        ProcessCounters counters;
+        int pid;
+        uint32_t generation;
+    };
+
+    std::vector<Slot> slots;
+    uint32_t generation;
+    size_t used;
+
+    size_t slotFor(int pid, uint64_t start_time) const;
+    void rehash(size_t capacity);
+};
+
+// Two generations of counters: the previous tick is read while the current
+// one is written, then they swap.
+class CounterHistory {
+public:
+    CounterHistory() : current_index(0) {}
+
+    // Make the last written generation the baseline and start a new one
+    void beginTick(size_t expected);
+
+    const ProcessCounters* previous(int pid, uint64_t start_time) const {
+        return tables[current_index ^ 1].find(pid, start_time);
+    }
+
+    void record(int pid, uint64_t start_time, const ProcessCounters& counters) {
+        tables[current_index].insert(pid, start_time, counters);
+    }
+
+private:
+    CounterTable tables[2];
+    int current_index;
+};
+
+#endif // COUNTER_TABLE_HPP
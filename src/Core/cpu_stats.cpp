@@ -0,0 +1,184 @@
+#include "cpu_stats.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+inline uint64_t subClamped(uint64_t a, uint64_t b) {
+    return a > b ? a - b : 0;
+}
+
+} // namespace
+
+double taskCpuPercent(uint64_t delta_ticks, double interval_seconds) {
+    // Оба значения не меняются, пока работает процесс
+    static const double ticks_per_second = [] {
+        long ticks = sysconf(_SC_CLK_TCK);
+        return ticks > 0 ? static_cast<double>(ticks) : 100.0;
+    }();
+    static const double max_percent = [] {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        return 100.0 * static_cast<double>(cpus > 0 ? cpus : 1);
+    }();
+
+    if (interval_seconds <= 0.0) return 0.0;
+    double percent = static_cast<double>(delta_ticks) / ticks_per_second / interval_seconds * 100.0;
+    // Тики и часы снимаются не в один момент - небольшой выброс срезаем
+    return std::min(percent, max_percent);
+}
+
+double SampleClock::tick() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t now_ns = static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+
+    interval_seconds = last_ns > 0 ? static_cast<double>(now_ns - last_ns) / 1e9 : 0.0;
+    last_ns = now_ns;
+    return interval_seconds;
+}
+
+CpuStatsReader::CpuStatsReader()
+    : buffer(16 * 1024), rows(0), has_previous(false), total() {
+    total.cpu = -1;
+}
+
+bool CpuStatsReader::update() {
+    size_t length = 0;
+    if (!readFile(length) || !parse(length)) {
+        has_previous = false;
+        return false;
+    }
+
+    if (has_previous) {
+        computeDeltas();
+    } else if (!per_core.empty()) {
+        // Набор CPU изменился (hotplug): прежние строки относятся к другим
+        // CPU, до следующего замера показываем новый набор с нулями
+        per_core.assign(rows - 1, CpuCoreStats{});
+        for (size_t row = 1; row < rows; ++row) {
+            per_core[row - 1].cpu = row_cpu[row];
+        }
+    }
+
+    previous.swap(current);
+    has_previous = true;
+    return true;
+}
+
+bool CpuStatsReader::readFile(size_t& length) {
+    int fd = ::open("/proc/stat", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    // Строка intr на больших машинах бывает длинной, поэтому буфер растёт по необходимости
+    length = 0;
+    while (true) {
+        if (length + 1 >= buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+
+        ssize_t n = ::read(fd, buffer.data() + length, buffer.size() - length - 1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        length += static_cast<size_t>(n);
+    }
+
+    ::close(fd);
+    buffer[length] = '\0';
+    return length > 0;
+}
+
+bool CpuStatsReader::parse(size_t length) {
+    const char* p = buffer.data();
+    const char* end = p + length;
+
+    size_t row = 0;
+    while (p + 3 < end && p[0] == 'c' && p[1] == 'p' && p[2] == 'u') {
+        p += 3;
+
+        int cpu = -1;
+        if (*p >= '0' && *p <= '9') {
+            cpu = 0;
+            while (*p >= '0' && *p <= '9') {
+                cpu = cpu * 10 + (*p++ - '0');
+            }
+        }
+
+        // При изменении набора CPU (hotplug) начинаем накопление заново
+        if (row >= row_cpu.size()) {
+            row_cpu.push_back(cpu);
+            has_previous = false;
+        } else if (row_cpu[row] != cpu) {
+            row_cpu[row] = cpu;
+            has_previous = false;
+        }
+        if (current.size() < (row + 1) * FIELD_COUNT) {
+            current.resize((row + 1) * FIELD_COUNT);
+        }
+
+        // На старых ядрах guest/guest_nice отсутствуют - остаются нулями
+        uint64_t* values = &current[row * FIELD_COUNT];
+        for (int field = 0; field < FIELD_COUNT; ++field) {
+            while (*p == ' ') ++p;
+            uint64_t value = 0;
+            while (*p >= '0' && *p <= '9') {
+                value = value * 10 + static_cast<uint64_t>(*p++ - '0');
+            }
+            values[field] = value;
+        }
+
+        while (p < end && *p != '\n') ++p;
+        if (p < end) ++p;
+        ++row;
+    }
+
+    if (row == 0) return false;
+    if (row != rows) {
+        rows = row;
+        row_cpu.resize(rows);
+        has_previous = false;
+    }
+    current.resize(rows * FIELD_COUNT);
+    previous.resize(rows * FIELD_COUNT);
+    return true;
+}
+
+void CpuStatsReader::computeDeltas() {
+    // Один проход по непрерывной матрице, без ветвлений по полям -
+    // компилятор векторизует его
+    const size_t count = rows * FIELD_COUNT;
+    delta.resize(count);
+    const uint64_t* cur = current.data();
+    const uint64_t* prev = previous.data();
+    uint64_t* out = delta.data();
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = cur[i] >= prev[i] ? cur[i] - prev[i] : 0;
+    }
+
+    per_core.resize(rows - 1);
+    for (size_t row = 0; row < rows; ++row) {
+        const uint64_t* d = &delta[row * FIELD_COUNT];
+        CpuCoreStats& stats = row == 0 ? total : per_core[row - 1];
+        stats.cpu = row_cpu[row];
+
+        // guest уже входит в user/nice, поэтому в общую сумму не добавляется
+        uint64_t sum = d[USER] + d[NICE] + d[SYSTEM] + d[IDLE] + d[IOWAIT] + d[IRQ] + d[SOFTIRQ] + d[STEAL];
+        if (sum == 0) {
+            stats.user = stats.system = stats.iowait = stats.irq = 0.0;
+            stats.softirq = stats.steal = stats.guest = stats.total = 0.0;
+            continue;
+        }
+
+        double scale = 100.0 / static_cast<double>(sum);
+        stats.user = scale * static_cast<double>(subClamped(d[USER], d[GUEST]) + subClamped(d[NICE], d[GUEST_NICE]));
+        stats.system = scale * static_cast<double>(d[SYSTEM]);
+        stats.iowait = scale * static_cast<double>(d[IOWAIT]);
+        stats.irq = scale * static_cast<double>(d[IRQ]);
+        stats.softirq = scale * static_cast<double>(d[SOFTIRQ]);
+        stats.steal = scale * static_cast<double>(d[STEAL]);
+        stats.guest = scale * static_cast<double>(d[GUEST] + d[GUEST_NICE]);
+        stats.total = scale * static_cast<double>(subClamped(sum, d[IDLE] + d[IOWAIT]));
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef CPU_STATS_HPP
+#define CPU_STATS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Utilization of one CPU (or of all CPUs together) over the last interval, in percent
+struct CpuCoreStats {
+    int cpu; // -1 for the aggregate line
+    double user;
+    double system;
+    double iowait;
+    double irq;
+    double softirq;
+    double steal;
+    double guest;
+    double total; // everything except idle and iowait
+};
+
+// Reads every cpu line of /proc/stat into a flat counter matrix
+// (one row per CPU, FIELD_COUNT columns) and computes all deltas in a single
+// pass over contiguous memory.
+class CpuStatsReader {
+public:
+    enum Field {
+        USER, NICE, SYSTEM, IDLE, IOWAIT, IRQ, SOFTIRQ, STEAL, GUEST, GUEST_NICE,
+        FIELD_COUNT
+    };
+
+    CpuStatsReader();
+    ~CpuStatsReader() = default;
+
+    // Sample /proc/stat; returns false if it could not be read
+    bool update();
+
+    const CpuCoreStats& aggregate() const { return total; }
+    const std::vector<CpuCoreStats>& cores() const { return per_core; }
+
+private:
+    std::vector<char> buffer;
+    std::vector<uint64_t> current;  // rows * FIELD_COUNT, строка 0 - суммарная
+    std::vector<uint64_t> previous;
+    std::vector<uint64_t> delta;
+    std::vector<int> row_cpu;       // номер CPU для каждой строки
+    size_t rows;
+    bool has_previous;
+
+    CpuCoreStats total;
+    std::vector<CpuCoreStats> per_core;
+
+    bool readFile(size_t& length);
+    bool parse(size_t length);
+    void computeDeltas();
+};
+
+// CPU time of one task over an interval, in percent of a single CPU (a busy
+// thread shows 100%, a process can reach 100% times the online CPUs).
+// delta_ticks are clock ticks as in utime/stime of /proc/PID/stat; the
+// interval is wall time, so a slow scan does not inflate the result.
+double taskCpuPercent(uint64_t delta_ticks, double interval_seconds);
+
+// Wall time between consecutive samples on CLOCK_MONOTONIC
+class SampleClock {
+public:
+    SampleClock() : last_ns(0), interval_seconds(0.0) {}
+
+    // Take a sample; returns the seconds since the previous one (0 on the first)
+    double tick();
+    double interval() const { return interval_seconds; }
+
+private:
+    int64_t last_ns;
+    double interval_seconds;
+};
+
+#endif // CPU_STATS_HPP
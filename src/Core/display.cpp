@@ -0,0 +1,488 @@
+#include "display.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+// Готовые escape-последовательности, чтобы не собирать их на каждом кадре
+constexpr std::string_view RESET = "\033[0m";
+constexpr std::string_view BRIGHT_CYAN = "\033[1;36m";
+constexpr std::string_view BRIGHT_MAGENTA = "\033[1;35m";
+constexpr std::string_view BRIGHT_YELLOW = "\033[1;33m";
+constexpr std::string_view BRIGHT_GREEN = "\033[1;32m";
+constexpr std::string_view BRIGHT_BLUE = "\033[1;34m";
+constexpr std::string_view BRIGHT_RED = "\033[1;31m";
+constexpr std::string_view BRIGHT_WHITE = "\033[1;37m";
+constexpr std::string_view BRIGHT_GRAY = "\033[1;90m";
+constexpr std::string_view GREEN = "\033[32m";
+constexpr std::string_view YELLOW = "\033[33m";
+
+constexpr std::string_view HEATMAP_LEVELS[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+
+constexpr std::string_view FOOTER_KEYS = "[q]uit [m]emory [c]pu [p]id [n]ame [r]everse [f]ilter [+/-] delay [h]elp | Update: ";
+
+// Ширина текстовых колонок таблицы процессов
+constexpr int PID_WIDTH = 7;
+constexpr int NAME_WIDTH = 15; // comm не длиннее 15 символов
+constexpr int STATE_WIDTH = 5;
+constexpr int USER_WIDTH = 8;
+constexpr int CPU_WIDTH = 6;
+constexpr int MEMORY_WIDTH = 9;
+constexpr int DETAIL_WIDTH = 8; // PSS, USS, SWAP
+
+// Ширина таблицы без колонок группы и команды; колонка команды занимает
+// остаток строки терминала и не рисуется, если он уже этого
+constexpr int TABLE_WIDTH = 79;
+constexpr int MIN_COMMAND_WIDTH = 16;
+
+// Число заполненных делений шкалы, ограниченное её шириной
+inline int filledCells(double value, double max_value, int width) {
+    int filled = static_cast<int>(value / max_value * width);
+    return std::max(0, std::min(width, filled));
+}
+
+} // namespace
+
+Display::Display(const MtopConfig& cfg) : config(cfg) {
+    if (config.show_colors) {
+        // Скрываем курсор
+        std::cout << "\033[?25l" << std::flush;
+    }
+}
+
+Display::~Display() {
+    if (config.show_colors) {
+        // Показываем курсор
+        std::cout << "\033[?25h";
+        std::cout << "\033[0m" << std::flush; // Сброс цветов
+    }
+}
+
+void Display::updateConfig(const MtopConfig& new_config) {
+    config = new_config;
+}
+
+void Display::resize() {
+    screen.resize();
+}
+
+void Display::render(const SystemStats& stats, std::string_view status) {
+    compose(stats, status);
+    present();
+}
+
+std::string_view Display::compose(const SystemStats& stats, std::string_view status) {
+    clear();
+    printHeader();
+    printSystemStats(stats);
+    printProcesses(stats);
+    printFooter(status);
+    return frame.view();
+}
+
+void Display::showHelp() {
+    clear();
+    printHeader();
+    frame.append("\nKeyboard Commands:\n"
+                 "  q, Q, ESC  - Quit\n"
+                 "  m, M       - Sort by Memory (default)\n"
+                 "  c, C       - Sort by CPU\n"
+                 "  p, P       - Sort by PID\n"
+                 "  n, N       - Sort by Name\n"
+                 "  r, R       - Reverse sort order\n"
+                 "  t, T       - Toggle network statistics\n"
+                 "  1          - Toggle per-core CPU heatmap\n"
+                 "  a, A       - Toggle full command line column\n"
+                 "  H          - Toggle threads of the listed processes\n"
+                 "  u, U       - Toggle PSS/USS/swap columns (smaps_rollup)\n"
+                 "  f, F       - Edit filter, e.g. user in (web,db) && rss > 1G\n"
+                 "  +, =       - Decrease update interval\n"
+                 "  -, _       - Increase update interval\n"
+                 "  h, ?       - Show this help\n\n"
+                 "Press any key to continue...");
+    present();
+}
+
+void Display::leave() {
+    if (config.show_colors) {
+        screen.leave();
+    }
+}
+
+void Display::clear() {
+    // Новый кадр; буфер сохраняет ёмкость, очистку экрана делает Screen
+    frame.clear();
+    if (!config.show_colors) {
+        // Простая очистка для терминалов без цветов
+        frame.repeat("\n", 50);
+    }
+}
+
+void Display::present() {
+    // Весь кадр уходит в терминал одним write()
+    screen.present(frame.view(), config.show_colors);
+}
+
+void Display::printFooter(std::string_view status) {
+    frame.append('\n');
+    if (config.show_colors) frame.append(BRIGHT_GRAY);
+    if (status.empty()) {
+        frame.append(FOOTER_KEYS);
+        if (config.interval_ms > 0) {
+            // Доли секунды из --interval, без лишних нулей
+            int precision = config.interval_ms % 1000 == 0 ? 0 : config.interval_ms % 100 == 0 ? 1 : 2;
+            frame.appendFixed(config.interval_ms / 1000.0, precision);
+        } else {
+            frame.appendInt(config.update_interval);
+        }
+        frame.append('s');
+        if (config.show_threads) {
+            frame.append(" | Threads");
+        }
+        if (!config.filter.empty()) {
+            frame.append(" | Filter: ");
+            frame.appendText(config.filter);
+        }
+    } else {
+        frame.appendText(status);
+    }
+    if (config.show_colors) frame.append(RESET);
+}
+
+void Display::printHeader() {
+    if (config.show_colors) {
+        frame.append(BRIGHT_CYAN); // Яркий голубой
+        frame.append("╭─────────────────────────────────────────────────────────────────────────────╮\n");
+        frame.append("│                              \033[1;35mmtop\033[1;36m - Modern Top                              │\n");
+        frame.append("╰─────────────────────────────────────────────────────────────────────────────╯\033[0m\n");
+    } else {
+        frame.append("===============================================================================\n");
+        frame.append("                              mtop - Modern Top                              \n");
+        frame.append("===============================================================================\n");
+    }
+}
+
+void Display::printSystemStats(const SystemStats& stats) {
+    if (config.show_colors) {
+        frame.append(BRIGHT_YELLOW); // Желтый для заголовков
+    }
+
+    // CPU
+    frame.append("CPU: ");
+    if (config.show_cpu_bar) {
+        if (config.show_colors) {
+            printProgressBar(stats.cpu_percent, 100.0, config.progress_bar_width);
+        } else {
+            printProgressBarText(stats.cpu_percent, 100.0, config.progress_bar_width);
+        }
+        frame.append(' ');
+    }
+    if (!stats.cpu_trend.empty()) {
+        printSparkline(stats.cpu_trend);
+        frame.append(' ');
+    }
+    frame.appendFixed(stats.cpu_percent, 1);
+    frame.append("%\n");
+
+    // Загрузка по ядрам
+    if (config.show_cpu_cores && !stats.cpu_cores.empty()) {
+        printCoreHeatmap(stats.cpu_cores);
+    }
+
+    // Memory
+    double mem_percent = (static_cast<double>(stats.used_memory_kb) / stats.total_memory_kb) * 100.0;
+    frame.append("MEM: ");
+    if (config.show_memory_bar) {
+        if (config.show_colors) {
+            printProgressBar(mem_percent, 100.0, config.progress_bar_width);
+        } else {
+            printProgressBarText(mem_percent, 100.0, config.progress_bar_width);
+        }
+        frame.append(' ');
+    }
+    if (!stats.memory_trend.empty()) {
+        printSparkline(stats.memory_trend);
+        frame.append(' ');
+    }
+    frame.appendFixed(mem_percent, 1);
+    frame.append("% (");
+    frame.appendBytes(stats.used_memory_kb * 1024);
+    frame.append('/');
+    frame.appendBytes(stats.total_memory_kb * 1024);
+    frame.append(")\n");
+
+    // Load Average
+    if (config.show_load_avg) {
+        frame.append("Load: ");
+        if (config.show_colors) frame.append(BRIGHT_GREEN);
+        for (int i = 0; i < 3; ++i) {
+            if (i > 0) frame.append(' ');
+            frame.appendFixed(stats.load_avg[i], 2);
+        }
+        if (config.show_colors) frame.append(RESET);
+    }
+
+    frame.append("  Processes: ");
+    if (config.show_colors) frame.append(BRIGHT_GREEN);
+    frame.appendInt(stats.process_count);
+    if (config.show_colors) frame.append(RESET);
+    frame.append('\n');
+
+    // Network statistics
+    if (config.show_network_stats && !stats.network_interfaces.empty()) {
+        if (config.show_colors) frame.append(BRIGHT_YELLOW); // Желтый для заголовков
+        frame.append("Network: ");
+        if (config.show_colors) frame.append(BRIGHT_CYAN); // Голубой для данных
+
+        for (size_t i = 0; i < stats.network_interfaces.size(); ++i) {
+            const auto& net = stats.network_interfaces[i];
+            if (i > 0) frame.append(" | ");
+            frame.appendText(net.interface);
+            frame.append(" RX:");
+            frame.appendBytes(net.rx_bytes);
+            frame.append(" TX:");
+            frame.appendBytes(net.tx_bytes);
+        }
+        if (config.show_colors) frame.append(RESET);
+        frame.append('\n');
+    }
+
+    frame.append('\n');
+}
+
+void Display::printProcesses(const SystemStats& stats) {
+    // Колонка группы показывается только по запросу
+    const bool group = config.show_process_group;
+    const bool threads = config.show_threads;
+    const bool detail = config.show_memory_detail;
+    const std::string_view separator = config.show_colors ? " │ " : " | ";
+    
+    // Командная строка занимает всё, что осталось от ширины терминала
+    int command_width = screen.width() - TABLE_WIDTH - (group ? USER_WIDTH + 3 : 0) -
+                        (detail ? 3 * (DETAIL_WIDTH + 3) : 0) - 3;
+    const bool command = config.show_command_line && command_width >= MIN_COMMAND_WIDTH;
+    
+    if (config.show_colors) {
+        frame.append(BRIGHT_BLUE); // Синий для заголовка таблицы
+        frame.append("┌─────────┬─────────┬─────────────────┬───────┬──────────┬");
+        if (group) frame.append("──────────┬");
+        frame.append("────────┬───────────");
+        if (detail) frame.append("┬──────────┬──────────┬──────────");
+        if (command) {
+            frame.append("┬");
+            frame.repeat("─", command_width + 2);
+        }
+        frame.append("┐\n");
+        frame.append(threads ? "│   TID   │" : "│   PID   │");
+        frame.append("  PPID   │      NAME       │ STATE │   USER   │");
+        if (group) frame.append("  GROUP   │");
+        frame.append("  CPU%  │  MEMORY   │");
+        if (detail) frame.append("   PSS    │   USS    │   SWAP   │");
+        if (command) {
+            frame.append(" ");
+            frame.appendField("COMMAND", command_width);
+            frame.append(" │");
+        }
+        frame.append("\n");
+        frame.append("├─────────┼─────────┼─────────────────┼───────┼──────────┼");
+        if (group) frame.append("──────────┼");
+        frame.append("────────┼───────────");
+        if (detail) frame.append("┼──────────┼──────────┼──────────");
+        if (command) {
+            frame.append("┼");
+            frame.repeat("─", command_width + 2);
+        }
+        frame.append("┤\033[0m\n");
+    } else {
+        frame.append("---------+---------+-----------------+-------+----------+");
+        if (group) frame.append("----------+");
+        frame.append("--------+-----------");
+        if (detail) frame.append("+----------+----------+----------");
+        if (command) {
+            frame.append("+");
+            frame.repeat("-", command_width + 2);
+        }
+        frame.append("\n");
+        frame.append(threads ? "   TID   |" : "   PID   |");
+        frame.append("  PPID   |      NAME       | STATE |   USER   |");
+        if (group) frame.append("  GROUP   |");
+        frame.append("  CPU%  |  MEMORY   ");
+        if (detail) frame.append("|   PSS    |   USS    |   SWAP   ");
+        if (command) {
+            frame.append("| ");
+            frame.appendField("COMMAND", command_width);
+        }
+        frame.append("\n");
+        frame.append("---------+---------+-----------------+-------+----------+");
+        if (group) frame.append("----------+");
+        frame.append("--------+-----------");
+        if (detail) frame.append("+----------+----------+----------");
+        if (command) {
+            frame.append("+");
+            frame.repeat("-", command_width + 2);
+        }
+        frame.append("\n");
+    }
+
+    for (const auto& proc : stats.processes) {
+        frame.append(config.show_colors ? "│ " : " ");
+        frame.appendField(proc.pid, PID_WIDTH);
+        frame.append(separator);
+        frame.appendField(proc.ppid, PID_WIDTH);
+        frame.append(separator);
+
+        // Имя процесса (обрезаем если длинное)
+        if (config.show_colors) frame.append(BRIGHT_WHITE);
+        frame.appendField(proc.name, NAME_WIDTH);
+        if (config.show_colors) frame.append(RESET);
+        frame.append(separator);
+
+        // Состояние с цветом
+        if (config.show_process_state) {
+            if (config.show_colors) {
+                std::string_view state_color = BRIGHT_GREEN; // Зеленый по умолчанию
+                if (proc.state == "Z") state_color = BRIGHT_RED; // Красный для зомби
+                else if (proc.state == "D") state_color = BRIGHT_YELLOW; // Желтый для ожидания
+                frame.append(state_color);
+            }
+            frame.appendField(proc.state, STATE_WIDTH);
+            if (config.show_colors) frame.append(RESET);
+        } else {
+            frame.appendField("", STATE_WIDTH);
+        }
+        frame.append(separator);
+
+        // Пользователь
+        if (config.show_process_user) {
+            if (config.show_colors) frame.append(BRIGHT_CYAN);
+            frame.appendField(proc.user, USER_WIDTH);
+            if (config.show_colors) frame.append(RESET);
+        } else {
+            frame.appendField("", USER_WIDTH);
+        }
+        frame.append(separator);
+
+        // Группа
+        if (group) {
+            if (config.show_colors) frame.append(BRIGHT_CYAN);
+            frame.appendField(proc.group, USER_WIDTH);
+            if (config.show_colors) frame.append(RESET);
+            frame.append(separator);
+        }
+
+        // CPU за последний интервал, 100% - одно ядро
+        frame.appendField(proc.cpu_percent, 1, CPU_WIDTH);
+        frame.append(separator);
+
+        // Память: размер форматируем во временный буфер, чтобы выровнять вправо
+        char size_text[32];
+        size_t size_len = FrameBuffer::formatBytes(proc.memory_kb * 1024, size_text, sizeof(size_text));
+        if (config.show_colors) frame.append(BRIGHT_MAGENTA);
+        frame.appendField(std::string_view(size_text, size_len), MEMORY_WIDTH, FrameBuffer::Align::RIGHT);
+        if (config.show_colors) frame.append(RESET);
+
+        // PSS, USS и swap из smaps_rollup; "-", пока процесс не прочитан
+        if (detail) {
+            for (uint64_t kb : {proc.pss_kb, proc.uss_kb, proc.swap_kb}) {
+                frame.append(separator);
+                if (proc.memory_detail) {
+                    size_len = FrameBuffer::formatBytes(kb * 1024, size_text, sizeof(size_text));
+                    frame.appendField(std::string_view(size_text, size_len), DETAIL_WIDTH, FrameBuffer::Align::RIGHT);
+                } else {
+                    frame.appendField("-", DETAIL_WIDTH, FrameBuffer::Align::RIGHT);
+                }
+            }
+        }
+
+        // Командная строка; у kernel threads и зомби её нет - показываем имя
+        if (command) {
+            frame.append(separator);
+            frame.appendField(proc.command.empty() ? proc.name : proc.command, command_width);
+        }
+
+        frame.append(config.show_colors ? " │\n" : " \n");
+    }
+
+    if (config.show_colors) {
+        frame.append("\033[1;34m└─────────┴─────────┴─────────────────┴───────┴──────────┴");
+        if (group) frame.append("──────────┴");
+        frame.append("────────┴───────────");
+        if (detail) frame.append("┴──────────┴──────────┴──────────");
+        if (command) {
+            frame.append("┴");
+            frame.repeat("─", command_width + 2);
+        }
+        frame.append("┘\033[0m\n");
+    } else {
+        frame.append("---------+---------+-----------------+-------+----------+");
+        if (group) frame.append("----------+");
+        frame.append("--------+-----------");
+        if (detail) frame.append("+----------+----------+----------");
+        if (command) {
+            frame.append("+");
+            frame.repeat("-", command_width + 2);
+        }
+        frame.append("\n");
+    }
+}
+
+void Display::printProgressBar(double value, double max_value, int width) {
+    int filled = filledCells(value, max_value, width);
+
+    frame.append("\033[1;32m["); // Зеленый для прогресс-бара
+    frame.repeat("█", filled);
+    frame.repeat("░", width - filled);
+    frame.append("]\033[0m");
+}
+
+void Display::printCoreHeatmap(const std::vector<CpuCoreStats>& cores) {
+    const size_t per_line = 64;
+
+    for (size_t i = 0; i < cores.size(); ++i) {
+        if (i % per_line == 0) {
+            if (i > 0) frame.append('\n');
+            frame.append("     ");
+        }
+
+        double load = std::max(0.0, std::min(100.0, cores[i].total));
+        if (config.show_colors) {
+            std::string_view color = GREEN;                       // Зеленый
+            if (load >= 85.0) color = BRIGHT_RED;                 // Красный
+            else if (load >= 60.0) color = BRIGHT_YELLOW;         // Желтый
+            else if (load >= 25.0) color = YELLOW;                // Оранжевый
+            frame.append(color);
+            frame.append(HEATMAP_LEVELS[std::min(7, static_cast<int>(load / 12.5))]);
+        } else {
+            frame.append(static_cast<char>('0' + std::min(9, static_cast<int>(load / 10.0))));
+        }
+    }
+    if (config.show_colors) frame.append(RESET);
+    frame.append('\n');
+}
+
+void Display::printSparkline(const std::vector<HistoryPoint>& points) {
+    // Средние по корзинам истории, 0..100%; пустые корзины остаются пробелами
+    if (config.show_colors) frame.append(BRIGHT_CYAN);
+    for (const auto& point : points) {
+        if (point.count == 0) {
+            frame.append(' ');
+            continue;
+        }
+        double value = std::max(0.0, std::min(100.0, static_cast<double>(point.avg)));
+        if (config.show_colors) {
+            frame.append(HEATMAP_LEVELS[std::min(7, static_cast<int>(value / 12.5))]);
+        } else {
+            frame.append(static_cast<char>('0' + std::min(9, static_cast<int>(value / 10.0))));
+        }
+    }
+    if (config.show_colors) frame.append(RESET);
+}
+
+void Display::printProgressBarText(double value, double max_value, int width) {
+    int filled = filledCells(value, max_value, width);
+
+    frame.append('[');
+    frame.repeat("#", filled);
+    frame.repeat("-", width - filled);
+    frame.append(']');
+}
@@ -0,0 +1,54 @@
+#ifndef DISPLAY_HPP
+#define DISPLAY_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "system_info.hpp"
+#include "screen.hpp"
+#include "frame_buffer.hpp"
+#include "parser.hpp"
+
+// Composes frames into a reusable FrameBuffer and hands them to Screen,
+// which sends only the cells that changed since the previous frame.
+class Display {
+public:
+    Display(const MtopConfig& config);
+    ~Display();
+
+    void updateConfig(const MtopConfig& new_config);
+
+    // Terminal size changed (SIGWINCH); the next frame is drawn in full
+    void resize();
+
+    // Draw the main view for a snapshot. A non-empty status replaces the
+    // key hints on the bottom line (used by replay).
+    void render(const SystemStats& stats, std::string_view status = {});
+
+    // Build that frame without drawing it; render() is compose() + present()
+    std::string_view compose(const SystemStats& stats, std::string_view status = {});
+
+    // Draw the keyboard help screen
+    void showHelp();
+
+    // Put the cursor below the last frame before printing anything else
+    void leave();
+
+private:
+    MtopConfig config;
+    Screen screen;
+    FrameBuffer frame;
+
+    void clear();
+    void present();
+    void printHeader();
+    void printSystemStats(const SystemStats& stats);
+    void printProcesses(const SystemStats& stats);
+    void printFooter(std::string_view status);
+    void printProgressBar(double value, double max_value, int width);
+    void printCoreHeatmap(const std::vector<CpuCoreStats>& cores);
+    void printSparkline(const std::vector<HistoryPoint>& points);
+    void printProgressBarText(double value, double max_value, int width);
+};
+
+#endif // DISPLAY_HPP
@@ -0,0 +1,107 @@
+#include "event_loop.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+
+bool addToEpoll(int epoll_fd, int fd) {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+} // namespace
+
+EventLoop::EventLoop(bool watch_input) : epoll_fd(-1), timer_fd(-1), signal_fd(-1), wakeup_fd(-1) {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+    // Сигналы приходят через signalfd, поэтому блокируем их обычную доставку
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGWINCH);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+    signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (epoll_fd >= 0) {
+        // Для stdin, перенаправленного из файла, epoll недоступен - это не ошибка
+        if (watch_input) addToEpoll(epoll_fd, STDIN_FILENO);
+        if (signal_fd >= 0) addToEpoll(epoll_fd, signal_fd);
+        if (timer_fd >= 0) addToEpoll(epoll_fd, timer_fd);
+    }
+}
+
+EventLoop::~EventLoop() {
+    if (timer_fd >= 0) close(timer_fd);
+    if (signal_fd >= 0) close(signal_fd);
+    if (epoll_fd >= 0) close(epoll_fd);
+}
+
+void EventLoop::watchWakeup(int fd) {
+    if (fd < 0 || epoll_fd < 0) return;
+    if (addToEpoll(epoll_fd, fd)) {
+        wakeup_fd = fd;
+    }
+}
+
+void EventLoop::setInterval(int64_t milliseconds) {
+    if (timer_fd < 0) return;
+
+    // Нулевой itimerspec остановил бы таймер, и обновления прекратились бы
+    milliseconds = std::max(milliseconds, MIN_INTERVAL_MS);
+
+    struct itimerspec spec = {};
+    spec.it_interval.tv_sec = milliseconds / 1000;
+    spec.it_interval.tv_nsec = (milliseconds % 1000) * 1000000;
+    spec.it_value = spec.it_interval;
+    timerfd_settime(timer_fd, 0, &spec, nullptr);
+}
+
+void EventLoop::stopTimer() {
+    if (timer_fd < 0) return;
+
+    struct itimerspec spec = {};
+    timerfd_settime(timer_fd, 0, &spec, nullptr);
+}
+
+unsigned EventLoop::wait(int timeout_ms) {
+    if (epoll_fd < 0) return QUIT;
+
+    struct epoll_event events[8];
+    int count;
+    do {
+        count = epoll_wait(epoll_fd, events, 8, timeout_ms);
+    } while (count < 0 && errno == EINTR);
+
+    unsigned result = 0;
+    for (int i = 0; i < count; ++i) {
+        int fd = events[i].data.fd;
+
+        if (fd == STDIN_FILENO) {
+            result |= INPUT;
+        } else if (fd == timer_fd) {
+            uint64_t expirations;
+            ssize_t ignored = read(timer_fd, &expirations, sizeof(expirations));
+            (void)ignored;
+            result |= TIMER;
+        } else if (fd == signal_fd) {
+            struct signalfd_siginfo info;
+            while (read(signal_fd, &info, sizeof(info)) == static_cast<ssize_t>(sizeof(info))) {
+                result |= info.ssi_signo == SIGWINCH ? RESIZE : QUIT;
+            }
+        } else if (fd == wakeup_fd) {
+            // Сам дескриптор вычитывает владелец (Collector::poll)
+            result |= WAKEUP;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,52 @@
+#ifndef EVENT_LOOP_HPP
+#define EVENT_LOOP_HPP
+
+#include <cstdint>
+
+// Blocks on a single epoll set instead of polling: stdin, a timerfd for the
+// refresh deadline, a signalfd for SIGINT/SIGTERM/SIGWINCH and an optional
+// wakeup descriptor (e.g. the collector's eventfd). Between events the
+// process does not wake up at all.
+//
+// Construct it before starting any thread: the signals are blocked in the
+// calling thread and new threads inherit that mask.
+class EventLoop {
+public:
+    enum Event : unsigned {
+        INPUT = 1u << 0,
+        TIMER = 1u << 1,
+        QUIT = 1u << 2,
+        RESIZE = 1u << 3,
+        WAKEUP = 1u << 4,
+    };
+
+    // watch_input = false leaves stdin alone (batch mode, stdin not a terminal)
+    explicit EventLoop(bool watch_input = true);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Also wake up when fd becomes readable
+    void watchWakeup(int fd);
+
+    // Fire TIMER every `milliseconds`; shorter intervals are raised to
+    // MIN_INTERVAL_MS, so a bad setting can never leave the timer disarmed
+    static constexpr int64_t MIN_INTERVAL_MS = 10;
+    void setInterval(int64_t milliseconds);
+
+    // Disarm the timer until the next setInterval()
+    void stopTimer();
+
+    // Block until something happens; returns a mask of Event bits.
+    // timeout_ms < 0 waits indefinitely.
+    unsigned wait(int timeout_ms = -1);
+
+private:
+    int epoll_fd;
+    int timer_fd;
+    int signal_fd;
+    int wakeup_fd;
+};
+
+#endif // EVENT_LOOP_HPP
@@ -0,0 +1,261 @@
+#include "frame_buffer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::string_view ELLIPSIS = "...";
+
+// Смещение в байтах, на котором заканчивается count-й код UTF-8
+size_t utf8Prefix(std::string_view text, size_t count) {
+    size_t pos = 0;
+    while (pos < text.size() && count > 0) {
+        ++pos;
+        // Пропускаем байты продолжения 10xxxxxx
+        while (pos < text.size() && (static_cast<unsigned char>(text[pos]) & 0xc0) == 0x80) ++pos;
+        --count;
+    }
+    return pos;
+}
+
+// Диапазоны кодов, которые занимают не одну ячейку: нулевой ширины
+// (управляющие, комбинируемые, форматирующие) и широкие (CJK, эмодзи).
+// Свой список вместо wcwidth(): тот зависит от локали, а кадр всегда в UTF-8.
+struct CodeRange {
+    uint32_t first;
+    uint32_t last;
+};
+
+constexpr CodeRange NOT_SINGLE_CELL[] = {
+    {0x0000, 0x001f},   {0x007f, 0x009f},   {0x0300, 0x036f},   {0x0483, 0x0489},   {0x0591, 0x05c7},
+    {0x0610, 0x061a},   {0x064b, 0x065f},   {0x0e31, 0x0e31},   {0x0e34, 0x0e3a},   {0x0e47, 0x0e4e},
+    {0x1100, 0x115f},   {0x1ab0, 0x1aff},   {0x1dc0, 0x1dff},   {0x200b, 0x200f},   {0x2028, 0x202e},
+    {0x2060, 0x206f},   {0x20d0, 0x20ff},   {0x231a, 0x231b},   {0x2329, 0x232a},   {0x23e9, 0x23ec},
+    {0x23f0, 0x23f0},   {0x23f3, 0x23f3},   {0x25fd, 0x25fe},   {0x2614, 0x2615},   {0x2648, 0x2653},
+    {0x267f, 0x267f},   {0x2693, 0x2693},   {0x26a1, 0x26a1},   {0x26aa, 0x26ab},   {0x26bd, 0x26be},
+    {0x26c4, 0x26c5},   {0x26ce, 0x26ce},   {0x26d4, 0x26d4},   {0x26ea, 0x26ea},   {0x26f2, 0x26f3},
+    {0x26f5, 0x26f5},   {0x26fa, 0x26fa},   {0x26fd, 0x26fd},   {0x2705, 0x2705},   {0x270a, 0x270b},
+    {0x2728, 0x2728},   {0x274c, 0x274c},   {0x274e, 0x274e},   {0x2753, 0x2755},   {0x2757, 0x2757},
+    {0x2795, 0x2797},   {0x27b0, 0x27b0},   {0x27bf, 0x27bf},   {0x2b1b, 0x2b1c},   {0x2b50, 0x2b50},
+    {0x2b55, 0x2b55},   {0x2e80, 0x303e},   {0x3041, 0x33ff},   {0x3400, 0x4dbf},   {0x4e00, 0x9fff},
+    {0xa000, 0xa4cf},   {0xa960, 0xa97f},   {0xac00, 0xd7a3},   {0xd800, 0xdfff},   {0xf900, 0xfaff},
+    {0xfe00, 0xfe19},   {0xfe20, 0xfe6f},   {0xfeff, 0xfeff},   {0xff00, 0xff60},   {0xffe0, 0xffe6},
+    {0x16fe0, 0x18aff}, {0x1b000, 0x1b2ff}, {0x1f004, 0x1f004}, {0x1f0cf, 0x1f0cf}, {0x1f18e, 0x1f18e},
+    {0x1f191, 0x1f19a}, {0x1f200, 0x1f2ff}, {0x1f300, 0x1f64f}, {0x1f680, 0x1f6ff}, {0x1f7e0, 0x1f7eb},
+    {0x1f900, 0x1f9ff}, {0x1fa70, 0x1faff}, {0x20000, 0x3fffd}, {0xe0000, 0xe0fff},
+};
+
+bool singleCell(uint32_t code) {
+    const CodeRange* end = std::end(NOT_SINGLE_CELL);
+    const CodeRange* range = std::lower_bound(std::begin(NOT_SINGLE_CELL), end, code,
+                                              [](const CodeRange& r, uint32_t c) { return r.last < c; });
+    return range == end || code < range->first;
+}
+
+// Код символа из последовательности UTF-8; false для испорченной или избыточной записи
+bool decodeUtf8(std::string_view unit, uint32_t& code) {
+    unsigned char lead = static_cast<unsigned char>(unit[0]);
+    size_t expected;
+    uint32_t minimum;
+    if (lead < 0x80) {
+        code = lead;
+        return unit.size() == 1;
+    } else if ((lead & 0xe0) == 0xc0) {
+        expected = 2;
+        minimum = 0x80;
+        code = lead & 0x1f;
+    } else if ((lead & 0xf0) == 0xe0) {
+        expected = 3;
+        minimum = 0x800;
+        code = lead & 0x0f;
+    } else if ((lead & 0xf8) == 0xf0) {
+        expected = 4;
+        minimum = 0x10000;
+        code = lead & 0x07;
+    } else {
+        return false;
+    }
+    if (unit.size() != expected) return false;
+    for (size_t i = 1; i < expected; ++i) {
+        code = (code << 6) | (static_cast<unsigned char>(unit[i]) & 0x3f);
+    }
+    return code >= minimum && code <= 0x10ffff;
+}
+
+} // namespace
+
+FrameBuffer::FrameBuffer(size_t capacity) : bytes(capacity), length(0) {
+}
+
+void FrameBuffer::append(const char* text, size_t len) {
+    reserve(len);
+    std::memcpy(bytes.data() + length, text, len);
+    length += len;
+}
+
+void FrameBuffer::repeat(std::string_view glyph, int count) {
+    if (count <= 0) return;
+    reserve(glyph.size() * static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        std::memcpy(bytes.data() + length, glyph.data(), glyph.size());
+        length += glyph.size();
+    }
+}
+
+void FrameBuffer::appendInt(int64_t value) {
+    reserve(24);
+    auto result = std::to_chars(bytes.data() + length, bytes.data() + bytes.size(), value);
+    length = static_cast<size_t>(result.ptr - bytes.data());
+}
+
+void FrameBuffer::appendUnsigned(uint64_t value) {
+    reserve(24);
+    auto result = std::to_chars(bytes.data() + length, bytes.data() + bytes.size(), value);
+    length = static_cast<size_t>(result.ptr - bytes.data());
+}
+
+void FrameBuffer::appendFixed(double value, int precision) {
+    // Хватает для любого double в фиксированной записи с разумной точностью
+    reserve(330 + static_cast<size_t>(precision));
+    auto result = std::to_chars(bytes.data() + length, bytes.data() + bytes.size(), value,
+                                std::chars_format::fixed, precision);
+    if (result.ec == std::errc()) {
+        length = static_cast<size_t>(result.ptr - bytes.data());
+    }
+}
+
+void FrameBuffer::appendText(std::string_view text) {
+    // '?' не длиннее заменяемого символа, так что места хватит на весь текст
+    reserve(text.size());
+    char* out = bytes.data() + length;
+
+    for (size_t pos = 0; pos < text.size();) {
+        char c = text[pos];
+        if (c >= 0x20 && c < 0x7f) {
+            // Обычный ASCII копируем без разбора
+            *out++ = c;
+            ++pos;
+            continue;
+        }
+
+        // Остальное - по одной ячейке на символ, как их считают columns() и utf8Prefix()
+        size_t next = pos + 1;
+        while (next < text.size() && (static_cast<unsigned char>(text[next]) & 0xc0) == 0x80) ++next;
+        std::string_view unit = text.substr(pos, next - pos);
+        uint32_t code;
+        if (decodeUtf8(unit, code) && singleCell(code)) {
+            std::memcpy(out, unit.data(), unit.size());
+            out += unit.size();
+        } else {
+            *out++ = '?';
+        }
+        pos = next;
+    }
+    length = static_cast<size_t>(out - bytes.data());
+}
+
+void FrameBuffer::appendField(std::string_view text, int width, Align align) {
+    size_t cols = columns(text);
+    size_t limit = width > 0 ? static_cast<size_t>(width) : 0;
+
+    if (cols > limit) {
+        // Обрезаем по границе символа, а не байта
+        size_t keep = limit > ELLIPSIS.size() ? limit - ELLIPSIS.size() : 0;
+        appendText(text.substr(0, utf8Prefix(text, keep)));
+        append(ELLIPSIS.substr(0, limit - keep));
+        return;
+    }
+
+    int padding = static_cast<int>(limit - cols);
+    if (align == Align::RIGHT) pad(padding);
+    appendText(text);
+    if (align == Align::LEFT) pad(padding);
+}
+
+void FrameBuffer::appendField(int64_t value, int width, Align align) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    appendField(std::string_view(digits, static_cast<size_t>(result.ptr - digits)), width, align);
+}
+
+void FrameBuffer::appendField(double value, int precision, int width, Align align) {
+    // Огромные значения не помещаются - такое поле остаётся пустым
+    char digits[64];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, precision);
+    size_t len = result.ec == std::errc() ? static_cast<size_t>(result.ptr - digits) : 0;
+    appendField(std::string_view(digits, len), width, align);
+}
+
+void FrameBuffer::appendBytes(uint64_t value) {
+    reserve(32);
+    length += formatBytes(value, bytes.data() + length, 32);
+}
+
+size_t FrameBuffer::formatBytes(uint64_t value, char* out, size_t size) {
+    static const char* const units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit_index = 0;
+    double scaled = static_cast<double>(value);
+
+    while (scaled >= 1024.0 && unit_index < 4) {
+        scaled /= 1024.0;
+        unit_index++;
+    }
+
+    // Сюда попадают только значения меньше 1024 PB, место под суффикс есть
+    auto result = std::to_chars(out, out + size, scaled, std::chars_format::fixed, 1);
+    if (result.ec != std::errc()) return 0;
+
+    size_t len = static_cast<size_t>(result.ptr - out);
+    for (const char* unit = units[unit_index]; *unit && len < size; ++unit) {
+        out[len++] = *unit;
+    }
+    return len;
+}
+
+bool FrameBuffer::writeTo(int fd) const {
+    // stdout может делить неблокирующий режим со stdin (один и тот же tty)
+    const char* p = bytes.data();
+    size_t remaining = length;
+    while (remaining > 0) {
+        ssize_t n = ::write(fd, p, remaining);
+        if (n > 0) {
+            p += n;
+            remaining -= static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && errno == EAGAIN) {
+            struct pollfd pfd = {fd, POLLOUT, 0};
+            ::poll(&pfd, 1, -1);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t FrameBuffer::columns(std::string_view text) {
+    // Байты продолжения в самом начале - тоже один символ, как в utf8Prefix()
+    size_t count = !text.empty() && (static_cast<unsigned char>(text[0]) & 0xc0) == 0x80 ? 1 : 0;
+    for (char c : text) {
+        if ((static_cast<unsigned char>(c) & 0xc0) != 0x80) ++count;
+    }
+    return count;
+}
+
+void FrameBuffer::grow(size_t needed) {
+    size_t capacity = bytes.size() ? bytes.size() : 1024;
+    while (capacity < needed) capacity *= 2;
+    bytes.resize(capacity);
+}
+
+void FrameBuffer::pad(int count) {
+    if (count <= 0) return;
+    reserve(static_cast<size_t>(count));
+    std::memset(bytes.data() + length, ' ', static_cast<size_t>(count));
+    length += static_cast<size_t>(count);
+}
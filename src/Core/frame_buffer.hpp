@@ -0,0 +1,77 @@
+#ifndef FRAME_BUFFER_HPP
+#define FRAME_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Growable byte buffer for building terminal frames and other output.
+// clear() keeps the capacity, so once warmed up appending never allocates.
+// Numbers are formatted with std::to_chars; text fields are padded and
+// truncated by UTF-8 code points rather than bytes.
+class FrameBuffer {
+public:
+    enum class Align { LEFT, RIGHT };
+
+    explicit FrameBuffer(size_t capacity = 16384);
+
+    void clear() { length = 0; }
+    const char* data() const { return bytes.data(); }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    std::string_view view() const { return std::string_view(bytes.data(), length); }
+
+    void append(char c) {
+        reserve(1);
+        bytes[length++] = c;
+    }
+    void append(std::string_view text) { append(text.data(), text.size()); }
+    void append(const char* text, size_t len);
+
+    // Append the same (possibly multi-byte) glyph count times
+    void repeat(std::string_view glyph, int count);
+
+    void appendInt(int64_t value);
+    void appendUnsigned(uint64_t value);
+    // Fixed notation with the given number of decimals, like %.Nf
+    void appendFixed(double value, int precision);
+
+    // Append text that comes from outside (process names, command lines,
+    // user input). Code points that do not take exactly one terminal cell -
+    // control characters, combining marks, wide CJK and emoji, broken
+    // UTF-8 - become '?', so columns() matches what the terminal shows.
+    void appendText(std::string_view text);
+
+    // Pad to width columns. Text wider than width is cut to width - 3
+    // columns followed by "...", which is how the process table shortens names.
+    // The text goes through appendText().
+    void appendField(std::string_view text, int width, Align align = Align::LEFT);
+    void appendField(int64_t value, int width, Align align = Align::RIGHT);
+    // Fixed notation like appendFixed(), padded like the overloads above
+    void appendField(double value, int precision, int width, Align align = Align::RIGHT);
+
+    // Human readable size: 1023.0B, 1.5KB, 12.0MB ...
+    void appendBytes(uint64_t bytes);
+    // Same format into a caller buffer; returns the number of characters written
+    static size_t formatBytes(uint64_t bytes, char* out, size_t size);
+
+    // Write the whole buffer to fd, retrying short writes and EAGAIN.
+    // Returns false if the descriptor failed.
+    bool writeTo(int fd) const;
+
+    // Number of UTF-8 code points in text
+    static size_t columns(std::string_view text);
+
+private:
+    std::vector<char> bytes;
+    size_t length;
+
+    void reserve(size_t extra) {
+        if (length + extra > bytes.size()) grow(length + extra);
+    }
+    void grow(size_t needed);
+    void pad(int count);
+};
+
+#endif // FRAME_BUFFER_HPP
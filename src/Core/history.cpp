@@ -0,0 +1,91 @@
+#include "history.hpp"
+#include <algorithm>
+
+HistorySeries::HistorySeries() {
+    size_t total = 0;
+    for (int i = 0; i < LEVELS; ++i) {
+        levels[i].offset = total;
+        total += CAPACITY[i];
+    }
+    points.resize(total);
+    clear();
+}
+
+void HistorySeries::clear() {
+    for (auto& level : levels) {
+        level.head = 0;
+        level.size = 0;
+        level.bucket = 0;
+        level.open = HistoryPoint{0.0f, 0.0f, 0.0f, 0};
+        level.sum = 0.0;
+    }
+}
+
+void HistorySeries::add(int64_t now_ms, float value) {
+    for (int i = 0; i < LEVELS; ++i) {
+        Level& level = levels[i];
+        int64_t bucket = now_ms / BUCKET_MS[i];
+
+        if (level.open.count > 0 && bucket != level.bucket) {
+            // Закрываем корзину; пропущенные интервалы остаются пустыми точками
+            level.open.avg = static_cast<float>(level.sum / level.open.count);
+            push(level, i, level.open);
+
+            int64_t gap = std::min<int64_t>(bucket - level.bucket - 1, static_cast<int64_t>(CAPACITY[i]));
+            for (int64_t g = 0; g < gap; ++g) {
+                push(level, i, HistoryPoint{0.0f, 0.0f, 0.0f, 0});
+            }
+            level.open.count = 0;
+        }
+
+        if (level.open.count == 0) {
+            level.bucket = bucket;
+            level.open = HistoryPoint{value, value, value, 0};
+            level.sum = 0.0;
+        }
+        level.open.min = std::min(level.open.min, value);
+        level.open.max = std::max(level.open.max, value);
+        level.sum += value;
+        level.open.count++;
+    }
+}
+
+void HistorySeries::recent(int level_index, size_t count, std::vector<HistoryPoint>& out) const {
+    out.clear();
+    if (level_index < 0 || level_index >= LEVELS || count == 0) return;
+
+    const Level& level = levels[level_index];
+    const size_t capacity = CAPACITY[level_index];
+    const bool has_open = level.open.count > 0;
+
+    size_t closed = std::min(level.size, has_open ? count - 1 : count);
+    for (size_t i = closed; i > 0; --i) {
+        size_t slot = (level.head + capacity - i) % capacity;
+        out.push_back(points[level.offset + slot]);
+    }
+
+    if (has_open) {
+        HistoryPoint point = level.open;
+        point.avg = static_cast<float>(level.sum / point.count);
+        out.push_back(point);
+    }
+}
+
+void HistorySeries::push(Level& level, int index, const HistoryPoint& point) {
+    const size_t capacity = CAPACITY[index];
+    points[level.offset + level.head] = point;
+    level.head = (level.head + 1) % capacity;
+    if (level.size < capacity) level.size++;
+}
+
+void History::recordSystem(int64_t now_ms, double cpu_percent, double memory_percent) {
+    series[CPU].add(now_ms, static_cast<float>(cpu_percent));
+    series[MEMORY].add(now_ms, static_cast<float>(memory_percent));
+}
+
+int History::levelFor(int64_t interval_ms) {
+    for (int i = 0; i < HistorySeries::LEVELS; ++i) {
+        if (HistorySeries::BUCKET_MS[i] >= interval_ms) return i;
+    }
+    return HistorySeries::LEVELS - 1;
+}
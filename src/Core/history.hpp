@@ -0,0 +1,72 @@
+#ifndef HISTORY_HPP
+#define HISTORY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One history bucket; count == 0 marks a bucket without samples
+struct HistoryPoint {
+    float min;
+    float max;
+    float avg;
+    uint32_t count;
+};
+
+// Ring buffers of one metric at several resolutions. Every level is fed
+// from the raw samples, so its min/max/avg are exact roll-ups over the
+// bucket width. All storage is allocated once in the constructor.
+class HistorySeries {
+public:
+    static constexpr int LEVELS = 3;
+    static constexpr int64_t BUCKET_MS[LEVELS] = {1000, 10000, 60000};
+    static constexpr size_t CAPACITY[LEVELS] = {120, 180, 240}; // 2 min, 30 min, 4 h
+
+    HistorySeries();
+
+    void add(int64_t now_ms, float value);
+    void clear();
+
+    // The last `count` buckets of a level, oldest first, ending with the
+    // bucket still being filled. Missing buckets come back with count 0.
+    void recent(int level, size_t count, std::vector<HistoryPoint>& out) const;
+
+private:
+    struct Level {
+        size_t offset;   // first point of this level in `points`
+        size_t head;     // next slot to overwrite
+        size_t size;
+        int64_t bucket;  // id of the bucket being accumulated
+        HistoryPoint open;
+        double sum;
+    };
+
+    std::vector<HistoryPoint> points;
+    std::array<Level, LEVELS> levels;
+
+    void push(Level& level, int index, const HistoryPoint& point);
+};
+
+// Fixed-budget history kept by SystemInfo for the CPU and MEM sparklines.
+// The memory used is the same after a minute or a year of uptime.
+class History {
+public:
+    enum Metric {
+        CPU,    // percent
+        MEMORY, // percent used
+        METRIC_COUNT
+    };
+
+    void recordSystem(int64_t now_ms, double cpu_percent, double memory_percent);
+
+    const HistorySeries& system(Metric metric) const { return series[metric]; }
+
+    // Finest level whose buckets are at least as long as the sampling interval
+    static int levelFor(int64_t interval_ms);
+
+private:
+    std::array<HistorySeries, METRIC_COUNT> series;
+};
+
+#endif // HISTORY_HPP
@@ -0,0 +1,227 @@
+#include "identity_cache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <grp.h>
+#include <pwd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr const char* WATCHED_FILES[] = {"passwd", "group", "nsswitch.conf"};
+
+int64_t fileMtime(const char* path) {
+    struct stat st;
+    if (stat(path, &st) != 0) return 0;
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+} // namespace
+
+IdentityCache::IdMap::IdMap() : slots(256, Slot{EMPTY, 0}), used(0) {
+}
+
+bool IdentityCache::IdMap::find(uint32_t key, uint32_t& value) const {
+    // Ключ-метка совпал бы с первым пустым слотом
+    if (key == EMPTY) return false;
+
+    size_t mask = slots.size() - 1;
+    for (size_t i = (key * 2654435761u) & mask;; i = (i + 1) & mask) {
+        if (slots[i].key == key) {
+            value = slots[i].value;
+            return true;
+        }
+        if (slots[i].key == EMPTY) return false;
+    }
+}
+
+void IdentityCache::IdMap::insert(uint32_t key, uint32_t value) {
+    if (key == EMPTY) return;
+    if ((used + 1) * 2 > slots.size()) grow();
+
+    size_t mask = slots.size() - 1;
+    for (size_t i = (key * 2654435761u) & mask;; i = (i + 1) & mask) {
+        if (slots[i].key == key) {
+            slots[i].value = value;
+            return;
+        }
+        if (slots[i].key == EMPTY) {
+            slots[i] = Slot{key, value};
+            ++used;
+            return;
+        }
+    }
+}
+
+void IdentityCache::IdMap::clear() {
+    std::fill(slots.begin(), slots.end(), Slot{EMPTY, 0});
+    used = 0;
+}
+
+void IdentityCache::IdMap::grow() {
+    std::vector<Slot> old(slots.size() * 2, Slot{EMPTY, 0});
+    old.swap(slots);
+    used = 0;
+    for (const auto& slot : old) {
+        if (slot.key != EMPTY) insert(slot.key, slot.value);
+    }
+}
+
+IdentityCache::IdentityCache() : inotify_fd(-1), etc_watch(-1), passwd_mtime(0), group_mtime(0) {
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd >= 0) {
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_ATTRIB;
+        etc_watch = inotify_add_watch(inotify_fd, "/etc", mask);
+        if (etc_watch < 0) {
+            close(inotify_fd);
+            inotify_fd = -1;
+        } else {
+            // Кэш sssd меняется при обновлении данных из LDAP/AD
+            inotify_add_watch(inotify_fd, "/var/lib/sss/mc", mask);
+        }
+    }
+
+    if (inotify_fd < 0) {
+        passwd_mtime = fileMtime("/etc/passwd");
+        group_mtime = fileMtime("/etc/group");
+    }
+}
+
+IdentityCache::~IdentityCache() {
+    if (inotify_fd >= 0) {
+        close(inotify_fd);
+    }
+}
+
+bool IdentityCache::refresh() {
+    if (!databasesChanged()) return false;
+    invalidate();
+    return true;
+}
+
+const std::string& IdentityCache::userName(uint32_t uid) {
+    if (uid == INVALID_ID) return unknownName();
+
+    uint32_t id;
+    if (!users.find(uid, id)) {
+        id = resolveUser(uid);
+        users.insert(uid, id);
+    }
+    return names.get(id);
+}
+
+const std::string& IdentityCache::groupName(uint32_t gid) {
+    if (gid == INVALID_ID) return unknownName();
+
+    uint32_t id;
+    if (!groups.find(gid, id)) {
+        id = resolveGroup(gid);
+        groups.insert(gid, id);
+    }
+    return names.get(id);
+}
+
+bool IdentityCache::userId(const std::string& name, uint32_t& uid) {
+    struct passwd pw;
+    struct passwd* result = nullptr;
+    char buffer[4096];
+
+    if (getpwnam_r(name.c_str(), &pw, buffer, sizeof(buffer), &result) != 0 || !result) {
+        return false;
+    }
+
+    uid = result->pw_uid;
+    users.insert(uid, names.intern(result->pw_name));
+    return true;
+}
+
+bool IdentityCache::groupId(const std::string& name, uint32_t& gid) {
+    struct group gr;
+    struct group* result = nullptr;
+    char buffer[4096];
+
+    if (getgrnam_r(name.c_str(), &gr, buffer, sizeof(buffer), &result) != 0 || !result) {
+        return false;
+    }
+
+    gid = result->gr_gid;
+    groups.insert(gid, names.intern(result->gr_name));
+    return true;
+}
+
+const std::string& IdentityCache::unknownName() {
+    static const std::string unknown = "?";
+    return unknown;
+}
+
+void IdentityCache::invalidate() {
+    users.clear();
+    groups.clear();
+    names.clear();
+}
+
+bool IdentityCache::databasesChanged() {
+    if (inotify_fd < 0) {
+        int64_t passwd_now = fileMtime("/etc/passwd");
+        int64_t group_now = fileMtime("/etc/group");
+        bool changed = passwd_now != passwd_mtime || group_now != group_mtime;
+        passwd_mtime = passwd_now;
+        group_mtime = group_now;
+        return changed;
+    }
+
+    bool changed = false;
+    alignas(struct inotify_event) char buffer[4096];
+
+    while (true) {
+        ssize_t n = read(inotify_fd, buffer, sizeof(buffer));
+        if (n <= 0) break;
+
+        for (ssize_t offset = 0; offset < n;) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                changed = true;
+                continue;
+            }
+
+            // Из /etc интересны только файлы учётных записей, кэш sssd - целиком
+            if (event->wd != etc_watch) {
+                changed = true;
+                continue;
+            }
+            if (event->len == 0) continue;
+            for (const char* file : WATCHED_FILES) {
+                if (std::strcmp(event->name, file) == 0) {
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    return changed;
+}
+
+uint32_t IdentityCache::resolveUser(uint32_t uid) {
+    struct passwd pw;
+    struct passwd* result = nullptr;
+    char buffer[4096];
+
+    if (getpwuid_r(uid, &pw, buffer, sizeof(buffer), &result) == 0 && result) {
+        return names.intern(result->pw_name);
+    }
+    return names.intern(std::to_string(uid));
+}
+
+uint32_t IdentityCache::resolveGroup(uint32_t gid) {
+    struct group gr;
+    struct group* result = nullptr;
+    char buffer[4096];
+
+    if (getgrgid_r(gid, &gr, buffer, sizeof(buffer), &result) == 0 && result) {
+        return names.intern(result->gr_name);
+    }
+    return names.intern(std::to_string(gid));
+}
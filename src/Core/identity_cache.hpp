@@ -0,0 +1,72 @@
+#ifndef IDENTITY_CACHE_HPP
+#define IDENTITY_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "string_interner.hpp"
+
+// Caches uid/gid -> name lookups.
+// Entries live until the account databases change: /etc/passwd, /etc/group,
+// /etc/nsswitch.conf and the sssd memory cache are watched with inotify
+// (or by mtime when inotify is unavailable). Lookups themselves never
+// issue syscalls once a name has been resolved.
+class IdentityCache {
+public:
+    IdentityCache();
+    ~IdentityCache();
+
+    IdentityCache(const IdentityCache&) = delete;
+    IdentityCache& operator=(const IdentityCache&) = delete;
+
+    // Drop cached names if the account databases changed; call once per tick.
+    // Returns true when they did, so ids resolved from names can be redone.
+    bool refresh();
+
+    // (uid_t)-1 is never a real id; it resolves to "?" without a lookup
+    static constexpr uint32_t INVALID_ID = 0xFFFFFFFFu;
+
+    const std::string& userName(uint32_t uid);
+    const std::string& groupName(uint32_t gid);
+
+    // Reverse lookups for filters configured by name
+    bool userId(const std::string& name, uint32_t& uid);
+    bool groupId(const std::string& name, uint32_t& gid);
+
+private:
+    // Открытая адресация: uid/gid -> id строки в names
+    class IdMap {
+    public:
+        IdMap();
+        bool find(uint32_t key, uint32_t& value) const;
+        void insert(uint32_t key, uint32_t value);
+        void clear();
+
+    private:
+        static constexpr uint32_t EMPTY = INVALID_ID; // метка пустого слота
+        struct Slot {
+            uint32_t key;
+            uint32_t value;
+        };
+        std::vector<Slot> slots;
+        size_t used;
+
+        void grow();
+    };
+
+    IdMap users;
+    IdMap groups;
+    StringInterner names;
+    int inotify_fd;
+    int etc_watch;
+    int64_t passwd_mtime;
+    int64_t group_mtime;
+
+    static const std::string& unknownName();
+    void invalidate();
+    bool databasesChanged();
+    uint32_t resolveUser(uint32_t uid);
+    uint32_t resolveGroup(uint32_t gid);
+};
+
+#endif // IDENTITY_CACHE_HPP
@@ -0,0 +1,199 @@
+#include "io_ring.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// Обёртки системных вызовов: glibc их не экспортирует
+int ringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int ringRegister(int fd, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+template <typename T>
+T* at(void* base, uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+} // namespace
+
+IoRing::IoRing()
+    : ring_fd(-1), sq_entries(0), cq_entries(0), to_submit(0), in_flight(0), enter_calls(0),
+      sq_ring(MAP_FAILED), sq_ring_size(0), cq_ring(MAP_FAILED), cq_ring_size(0), sqes(MAP_FAILED),
+      sqes_size(0), sq_tail(nullptr), sq_mask(nullptr), sq_array(nullptr), cq_head(nullptr), cq_tail(nullptr),
+      cq_mask(nullptr), cqes(nullptr) {
+}
+
+IoRing::~IoRing() {
+    release();
+}
+
+bool IoRing::setup(unsigned entries) {
+    release();
+
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = ringSetup(entries, &params);
+    if (fd < 0) return false;
+    ring_fd = fd;
+    sq_entries = params.sq_entries;
+    cq_entries = params.cq_entries;
+
+    // С IORING_FEAT_SINGLE_MMAP (5.4+) оба кольца лежат в одном отображении
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+        sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    }
+
+    sq_ring = ::mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+        release();
+        return false;
+    }
+    if (single) {
+        cq_ring = sq_ring;
+    } else {
+        cq_ring = ::mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                         IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            release();
+            return false;
+        }
+    }
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = ::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        release();
+        return false;
+    }
+
+    sq_tail = at<unsigned>(sq_ring, params.sq_off.tail);
+    sq_mask = at<unsigned>(sq_ring, params.sq_off.ring_mask);
+    sq_array = at<unsigned>(sq_ring, params.sq_off.array);
+    cq_head = at<unsigned>(cq_ring, params.cq_off.head);
+    cq_tail = at<unsigned>(cq_ring, params.cq_off.tail);
+    cq_mask = at<unsigned>(cq_ring, params.cq_off.ring_mask);
+    cqes = at<void>(cq_ring, params.cq_off.cqes);
+
+    // Кольцо есть, но ядро может не знать нужных операций
+    io_uring_probe* probe = static_cast<io_uring_probe*>(
+        std::calloc(1, sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op)));
+    bool usable = probe && ringRegister(fd, IORING_REGISTER_PROBE, probe, 256) == 0 &&
+                  probe->last_op >= IORING_OP_READ &&
+                  (probe->ops[IORING_OP_OPENAT].flags & IO_URING_OP_SUPPORTED) &&
+                  (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+    std::free(probe);
+    if (!usable) {
+        release();
+        return false;
+    }
+    return true;
+}
+
+void* IoRing::nextEntry() {
+    if (!ready() || to_submit + in_flight >= sq_entries) return nullptr;
+
+    // Хвост очереди пишем только мы; ядро читает его после release-записи
+    unsigned tail = *sq_tail;
+    unsigned index = tail & *sq_mask;
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++to_submit;
+    return sqe;
+}
+
+bool IoRing::prepareOpenat(const char* path, int flags, uint64_t user_data) {
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(nextEntry());
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = reinterpret_cast<uint64_t>(path);
+    sqe->open_flags = static_cast<uint32_t>(flags);
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool IoRing::prepareRead(int fd, void* buffer, unsigned length, uint64_t offset, uint64_t user_data) {
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(nextEntry());
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buffer);
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool IoRing::submitAndWait() {
+    // Одним вызовом отдаём всю очередь и ждём все завершения
+    while (to_submit > 0 || in_flight > 0) {
+        unsigned submit = static_cast<unsigned>(to_submit);
+        unsigned wait = static_cast<unsigned>(to_submit + in_flight);
+        int submitted = ringEnter(ring_fd, submit, wait, IORING_ENTER_GETEVENTS);
+        ++enter_calls;
+        if (submitted < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        to_submit -= static_cast<size_t>(submitted);
+        in_flight += static_cast<size_t>(submitted);
+
+        // Ждать дальше нечего, если все отданные запросы уже завершились
+        unsigned ready_count = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE) - *cq_head;
+        if (ready_count >= in_flight && to_submit == 0) break;
+    }
+    return true;
+}
+
+bool IoRing::nextCompletion(uint64_t& user_data, int& result) {
+    if (!ready()) return false;
+
+    unsigned head = *cq_head;
+    if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) return false;
+
+    const io_uring_cqe* cqe = static_cast<const io_uring_cqe*>(cqes) + (head & *cq_mask);
+    user_data = cqe->user_data;
+    result = cqe->res;
+    __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+    if (in_flight > 0) --in_flight;
+    return true;
+}
+
+bool IoRing::supported() {
+    static const bool result = [] {
+        IoRing probe;
+        return probe.setup(2);
+    }();
+    return result;
+}
+
+void IoRing::release() {
+    if (sqes != MAP_FAILED) ::munmap(sqes, sqes_size);
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) ::munmap(cq_ring, cq_ring_size);
+    if (sq_ring != MAP_FAILED) ::munmap(sq_ring, sq_ring_size);
+    if (ring_fd >= 0) ::close(ring_fd);
+
+    ring_fd = -1;
+    sq_ring = cq_ring = sqes = MAP_FAILED;
+    sq_entries = cq_entries = 0;
+    to_submit = in_flight = 0;
+}
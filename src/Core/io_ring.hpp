@@ -0,0 +1,75 @@
+#ifndef IO_RING_HPP
+#define IO_RING_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Minimal io_uring submission/completion ring on raw syscalls, enough to
+// batch openat and read requests. No liburing dependency: the kernel ABI
+// from <linux/io_uring.h> is used directly, and setup() fails cleanly on
+// kernels without io_uring (before 5.6 for openat/read), when it is
+// disabled by sysctl, or when a seccomp policy blocks it.
+//
+// One ring belongs to one thread; nothing here is synchronized.
+class IoRing {
+public:
+    IoRing();
+    ~IoRing();
+
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+
+    // Create a ring with room for `entries` queued requests
+    bool setup(unsigned entries);
+    bool ready() const { return ring_fd >= 0; }
+
+    // Queue requests; false when the submission queue is full
+    bool prepareOpenat(const char* path, int flags, uint64_t user_data);
+    bool prepareRead(int fd, void* buffer, unsigned length, uint64_t offset, uint64_t user_data);
+
+    // Submit everything queued and wait until all of it has completed.
+    // Returns false if the kernel refused the batch.
+    bool submitAndWait();
+
+    // Next completion: user_data of the request and its result
+    // (a descriptor or byte count, or -errno)
+    bool nextCompletion(uint64_t& user_data, int& result);
+
+    unsigned capacity() const { return sq_entries; }
+    size_t queued() const { return to_submit; }
+
+    // io_uring_enter() calls made by this ring
+    uint64_t enterCalls() const { return enter_calls; }
+
+    // Probe once whether this kernel can run the requests above
+    static bool supported();
+
+private:
+    int ring_fd;
+    unsigned sq_entries;
+    unsigned cq_entries;
+    size_t to_submit;
+    size_t in_flight;
+    uint64_t enter_calls;
+
+    // Отображённые кольца и указатели на их поля
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t cq_ring_size;
+    void* sqes;
+    size_t sqes_size;
+
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    void* cqes;
+
+    void* nextEntry();
+    void release();
+};
+
+#endif // IO_RING_HPP
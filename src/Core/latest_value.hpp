@@ -0,0 +1,48 @@
+#ifndef LATEST_VALUE_HPP
+#define LATEST_VALUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+// Lock-free hand-off of the newest value from one producer thread to one
+// consumer thread (a triple buffer). publish() never fails and never waits:
+// a value the consumer has not taken yet is replaced, so the consumer always
+// gets the most recent one.
+template <typename T>
+class LatestValue {
+public:
+    LatestValue() : middle(1), back(2), front(0) {}
+
+    LatestValue(const LatestValue&) = delete;
+    LatestValue& operator=(const LatestValue&) = delete;
+
+    // Producer side
+    void publish(T value) {
+        slots[back] = std::move(value);
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel);
+        back = previous & INDEX;
+    }
+
+    // Consumer side; returns false when nothing new was published
+    bool take(T& value) {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+
+        uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & INDEX;
+        value = std::move(slots[front]);
+        slots[front] = T();
+        return true;
+    }
+
+private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4; // в middle лежит ещё не забранное значение
+
+    T slots[3];
+    alignas(64) std::atomic<uint8_t> middle; // обмениваются оба потока
+    alignas(64) uint8_t back;                // только производитель
+    alignas(64) uint8_t front;               // только потребитель
+};
+
+#endif // LATEST_VALUE_HPP
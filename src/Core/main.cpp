@@ -1,280 +1,28 @@
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <iterator>
 #include <thread>
 #include <chrono>
 #include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
 #include <termios.h>
 #include <unistd.h>
-#include <sys/select.h>
 #include <fcntl.h>
 #include "system_info.hpp"
+#include "display.hpp"
+#include "batch_writer.hpp"
+#include "recording.hpp"
+#include "metrics_server.hpp"
+#include "shared_snapshot.hpp"
+#include "process_filter.hpp"
+#include "io_ring.hpp"
+#include "collector.hpp"
+#include "event_loop.hpp"
 #include "parser.hpp"
 
-class Display {
-public:
-    Display(const MtopConfig& config) : config(config) {
-        if (config.show_colors) {
-            // Скрываем курсор
-            std::cout << "\033[?25l";
-        }
-    }
-    
-    ~Display() {
-        if (config.show_colors) {
-            // Показываем курсор
-            std::cout << "\033[?25h";
-            std::cout << "\033[0m"; // Сброс цветов
-        }
-    }
-    
-    void updateConfig(const MtopConfig& new_config) {
-        config = new_config;
-    }
-    
-    void clear() {
-        if (config.show_colors) {
-            std::cout << "\033[2J\033[H";
-        } else {
-            // Простая очистка для терминалов без цветов
-            for (int i = 0; i < 50; ++i) {
-                std::cout << "\n";
-            }
-        }
-    }
-    
-    void printHeader() {
-        if (config.show_colors) {
-            std::cout << "\033[1;36m"; // Яркий голубой
-            std::cout << "╭─────────────────────────────────────────────────────────────────────────────╮\n";
-            std::cout << "│                              \033[1;35mmtop\033[1;36m - Modern Top                              │\n";
-            std::cout << "╰─────────────────────────────────────────────────────────────────────────────╯\033[0m\n";
-        } else {
-            std::cout << "===============================================================================\n";
-            std::cout << "                              mtop - Modern Top                              \n";
-            std::cout << "===============================================================================\n";
-        }
-    }
-    
-    void printSystemStats(const SystemStats& stats) {
-        if (config.show_colors) {
-            std::cout << "\033[1;33m"; // Желтый для заголовков
-        }
-        
-        // CPU
-        if (config.show_cpu_bar) {
-            std::cout << "CPU: ";
-            if (config.show_colors) {
-                printProgressBar(stats.cpu_percent, 100.0, config.progress_bar_width);
-            } else {
-                printProgressBarText(stats.cpu_percent, 100.0, config.progress_bar_width);
-            }
-            std::cout << " " << std::fixed << std::setprecision(1) << stats.cpu_percent << "%\n";
-        } else {
-            std::cout << "CPU: " << std::fixed << std::setprecision(1) << stats.cpu_percent << "%\n";
-        }
-        
-        // Memory
-        double mem_percent = (static_cast<double>(stats.used_memory_kb) / stats.total_memory_kb) * 100.0;
-        if (config.show_memory_bar) {
-            std::cout << "MEM: ";
-            if (config.show_colors) {
-                printProgressBar(mem_percent, 100.0, config.progress_bar_width);
-            } else {
-                printProgressBarText(mem_percent, 100.0, config.progress_bar_width);
-            }
-            std::cout << " " << std::fixed << std::setprecision(1) << mem_percent << "% ";
-            std::cout << "(" << formatBytes(stats.used_memory_kb * 1024) << "/" 
-                      << formatBytes(stats.total_memory_kb * 1024) << ")\n";
-        } else {
-            std::cout << "MEM: " << std::fixed << std::setprecision(1) << mem_percent << "% ";
-            std::cout << "(" << formatBytes(stats.used_memory_kb * 1024) << "/" 
-                      << formatBytes(stats.total_memory_kb * 1024) << ")\n";
-        }
-        
-        // Load Average
-        if (config.show_load_avg) {
-            std::cout << "Load: ";
-            if (config.show_colors) std::cout << "\033[1;32m";
-            std::cout << std::fixed << std::setprecision(2) 
-                      << stats.load_avg[0] << " " << stats.load_avg[1] << " " << stats.load_avg[2];
-            if (config.show_colors) std::cout << "\033[0m";
-        }
-        
-        std::cout << "  Processes: ";
-        if (config.show_colors) std::cout << "\033[1;32m";
-        std::cout << stats.process_count;
-        if (config.show_colors) std::cout << "\033[0m";
-        std::cout << "\n";
-        
-        // Network statistics
-        if (config.show_network_stats && !stats.network_interfaces.empty()) {
-            if (config.show_colors) std::cout << "\033[1;33m"; // Желтый для заголовков
-            std::cout << "Network: ";
-            if (config.show_colors) std::cout << "\033[1;36m"; // Голубой для данных
-            
-            for (size_t i = 0; i < stats.network_interfaces.size(); ++i) {
-                const auto& net = stats.network_interfaces[i];
-                if (i > 0) std::cout << " | ";
-                std::cout << net.interface << " RX:" << formatBytes(net.rx_bytes) 
-                         << " TX:" << formatBytes(net.tx_bytes);
-            }
-            if (config.show_colors) std::cout << "\033[0m";
-            std::cout << "\n";
-        }
-        
-        std::cout << "\n";
-    }
-    
-    void printProcesses(const SystemStats& stats) {
-        if (config.show_colors) {
-            std::cout << "\033[1;34m"; // Синий для заголовка таблицы
-            std::cout << "┌─────────┬────────────────────┬─────────┬──────────────┬──────────────┐\n";
-            std::cout << "│   PID   │        NAME        │  STATE  │     USER     │    MEMORY    │\n";
-            std::cout << "├─────────┼────────────────────┼─────────┼──────────────┼──────────────┤\033[0m\n";
-        } else {
-            std::cout << "---------+--------------------+---------+--------------+--------------\n";
-            std::cout << "   PID   |        NAME        |  STATE  |     USER     |    MEMORY    \n";
-            std::cout << "---------+--------------------+---------+--------------+--------------\n";
-        }
-        
-        for (const auto& proc : stats.processes) {
-            if (config.show_colors) {
-                std::cout << "│ ";
-            } else {
-                std::cout << " ";
-            }
-            
-            std::cout << std::setw(7) << proc.pid;
-            
-            if (config.show_colors) {
-                std::cout << " │ ";
-            } else {
-                std::cout << " | ";
-            }
-            
-            // Имя процесса (обрезаем если длинное)
-            std::string name = proc.name;
-            if (name.length() > 18) {
-                name = name.substr(0, 15) + "...";
-            }
-            
-            if (config.show_colors) std::cout << "\033[1;37m";
-            std::cout << std::setw(18) << std::left << name;
-            if (config.show_colors) std::cout << "\033[0m";
-            
-            if (config.show_colors) {
-                std::cout << " │ ";
-            } else {
-                std::cout << " | ";
-            }
-            
-            // Состояние с цветом
-            if (config.show_process_state) {
-                if (config.show_colors) {
-                    std::string state_color = "\033[1;32m"; // Зеленый по умолчанию
-                    if (proc.state == "Z") state_color = "\033[1;31m"; // Красный для зомби
-                    else if (proc.state == "D") state_color = "\033[1;33m"; // Желтый для ожидания
-                    std::cout << state_color;
-                }
-                std::cout << std::setw(7) << std::left << proc.state;
-                if (config.show_colors) std::cout << "\033[0m";
-            } else {
-                std::cout << std::setw(7) << " ";
-            }
-            
-            if (config.show_colors) {
-                std::cout << " │ ";
-            } else {
-                std::cout << " | ";
-            }
-            
-            // Пользователь
-            if (config.show_process_user) {
-                std::string user = proc.user;
-                if (user.length() > 12) {
-                    user = user.substr(0, 9) + "...";
-                }
-                if (config.show_colors) std::cout << "\033[1;36m";
-                std::cout << std::setw(12) << std::left << user;
-                if (config.show_colors) std::cout << "\033[0m";
-            } else {
-                std::cout << std::setw(12) << " ";
-            }
-            
-            if (config.show_colors) {
-                std::cout << " │ ";
-            } else {
-                std::cout << " | ";
-            }
-            
-            // Память
-            if (config.show_colors) std::cout << "\033[1;35m";
-            std::cout << std::setw(12) << std::right << formatBytes(proc.memory_kb * 1024);
-            if (config.show_colors) std::cout << "\033[0m";
-            
-            if (config.show_colors) {
-                std::cout << " │\n";
-            } else {
-                std::cout << " \n";
-            }
-        }
-        
-        if (config.show_colors) {
-            std::cout << "\033[1;34m└─────────┴────────────────────┴─────────┴──────────────┴──────────────┘\033[0m\n";
-        } else {
-            std::cout << "---------+--------------------+---------+--------------+--------------\n";
-        }
-    }
-    
-private:
-    MtopConfig config;
-    
-    void printProgressBar(double value, double max_value, int width) {
-        double percent = value / max_value;
-        int filled = static_cast<int>(percent * width);
-        
-        std::cout << "\033[1;32m["; // Зеленый для прогресс-бара
-        for (int i = 0; i < width; ++i) {
-            if (i < filled) {
-                std::cout << "█";
-            } else {
-                std::cout << "░";
-            }
-        }
-        std::cout << "]\033[0m";
-    }
-    
-    void printProgressBarText(double value, double max_value, int width) {
-        double percent = value / max_value;
-        int filled = static_cast<int>(percent * width);
-        
-        std::cout << "[";
-        for (int i = 0; i < width; ++i) {
-            if (i < filled) {
-                std::cout << "#";
-            } else {
-                std::cout << "-";
-            }
-        }
-        std::cout << "]";
-    }
-    
-    std::string formatBytes(uint64_t bytes) {
-        const char* units[] = {"B", "KB", "MB", "GB", "TB"};
-        int unit_index = 0;
-        double size = static_cast<double>(bytes);
-        
-        while (size >= 1024.0 && unit_index < 4) {
-            size /= 1024.0;
-            unit_index++;
-        }
-        
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(1) << size << units[unit_index];
-        return oss.str();
-    }
-};
-
 class KeyboardHandler {
 public:
     KeyboardHandler() {
@@ -310,10 +58,249 @@ private:
     struct termios orig_termios;
 };
 
-volatile bool running = true;
+// Клавиши +/- меняют интервал по секунде в пределах 1..10 с. Если он задан
+// через --interval, шаги идут по лестнице, включающей доли секунды.
+bool stepInterval(MtopConfig& config, bool faster) {
+    if (config.interval_ms <= 0) {
+        int next = config.update_interval + (faster ? -1 : 1);
+        if (next < 1 || next > 10) return false;
+        config.update_interval = next;
+        return true;
+    }
+
+    static constexpr int STEPS_MS[] = {100, 250, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000};
+    int next = config.interval_ms;
+    if (faster) {
+        for (int step : STEPS_MS) {
+            if (step < config.interval_ms) next = step;
+        }
+    } else {
+        for (auto it = std::rbegin(STEPS_MS); it != std::rend(STEPS_MS); ++it) {
+            if (*it > config.interval_ms) next = *it;
+        }
+    }
+    if (next == config.interval_ms) return false;
+    config.interval_ms = next;
+    return true;
+}
+
+// Режим --batch и --record: без терминала, выборки идут в stdout или в запись
+int runBatch(const MtopConfig& config) {
+    const bool recording = !config.record_file.empty();
+    Recorder recorder;
+    if (recording && !recorder.open(config.record_file)) {
+        std::cerr << "Error: cannot record to " << config.record_file << ": "
+                  << (errno == EINVAL ? "not an mtop recording" : std::strerror(errno)) << "\n";
+        return 1;
+    }
+    
+    // stdin не трогаем - под cron и systemd это не терминал
+    EventLoop events(false);
+    SystemInfo info(config);
+    BatchWriter writer(config, STDOUT_FILENO);
+    events.setInterval(config.interval_ms > 0 ? config.interval_ms : config.update_interval * 1000);
+    
+    // Первая выборка выходит через один интервал, чтобы проценты CPU были осмысленными
+    int written = 0;
+    while (config.iterations == 0 || written < config.iterations) {
+        unsigned ready = events.wait();
+        if (ready & EventLoop::QUIT) {
+            break;
+        }
+        if (!(ready & EventLoop::TIMER)) {
+            continue;
+        }
+        
+        info.updateStats();
+        SnapshotPtr snapshot = info.getSnapshot();
+        if (recording ? !recorder.append(*snapshot) : !writer.write(*snapshot)) {
+            if (recording) {
+                std::cerr << "Error: cannot write " << config.record_file << ": " << std::strerror(errno) << "\n";
+            }
+            return 1;
+        }
+        ++written;
+    }
+    
+    return 0;
+}
+
+// Режим --serve: одна выборка за интервал, один готовый ответ на всех клиентов
+int runServe(const MtopConfig& config) {
+    EventLoop events(false);
+    MetricsServer server(config);
+    if (!server.listen(config.serve_address)) {
+        std::cerr << "Error: cannot serve on " << config.serve_address << ": "
+                  << (errno == EINVAL ? "expected PORT, HOST:PORT or [IPV6]:PORT" : std::strerror(errno)) << "\n";
+        return 1;
+    }
+    events.watchWakeup(server.fd());
+    
+    SystemInfo info(config);
+    server.publish(*info.getSnapshot());
+    events.setInterval(config.interval_ms > 0 ? config.interval_ms : config.update_interval * 1000);
+    std::cerr << "mtop: serving OpenMetrics on " << config.serve_address << "/metrics\n";
+    
+    while (true) {
+        unsigned ready = events.wait();
+        if (ready & EventLoop::QUIT) {
+            break;
+        }
+        if (ready & EventLoop::TIMER) {
+            info.updateStats();
+            server.publish(*info.getSnapshot());
+            server.expireIdle();
+        }
+        if (ready & EventLoop::WAKEUP) {
+            server.handleEvents();
+        }
+    }
+    
+    return 0;
+}
 
-void signalHandler(int signal) {
-    running = false;
+// Режим --publish: один сбор на хост, зрители читают его из общей памяти
+int runPublish(const MtopConfig& config) {
+    const int64_t interval = config.interval_ms > 0 ? config.interval_ms : config.update_interval * 1000;
+    EventLoop events(false);
+    SharedPublisher publisher;
+    if (!publisher.create(SharedPublisher::DEFAULT_NAME, interval)) {
+        std::cerr << "Error: cannot publish to /dev/shm" << SharedPublisher::DEFAULT_NAME << ": "
+                  << (errno == EEXIST ? "another mtop --publish is running" : std::strerror(errno)) << "\n";
+        return 1;
+    }
+    
+    SystemInfo info(SharedPublisher::collectionConfig(config));
+    publisher.publish(*info.getSnapshot());
+    events.setInterval(interval);
+    
+    while (true) {
+        unsigned ready = events.wait();
+        if (ready & EventLoop::QUIT) {
+            break;
+        }
+        if (ready & EventLoop::TIMER) {
+            info.updateStats();
+            publisher.publish(*info.getSnapshot());
+        }
+    }
+    
+    return 0;
+}
+
+// Режим --replay: запись показывается тем же Display, что и живая система
+int runReplay(const MtopConfig& config) {
+    Replay replay;
+    if (!replay.open(config.replay_file)) {
+        std::cerr << "Error: cannot replay " << config.replay_file << ": "
+                  << (errno == EINVAL ? "not an mtop recording or empty" : std::strerror(errno)) << "\n";
+        return 1;
+    }
+    
+    // В записи только процессы, потоки не записываются
+    MtopConfig view = config;
+    view.show_threads = false;
+    
+    EventLoop events;
+    Display display(view);
+    KeyboardHandler keyboard;
+    const int64_t interval = config.interval_ms > 0 ? config.interval_ms : config.update_interval * 1000;
+    
+    // Шаг клавишами [ и ]
+    const size_t jump = 60;
+    const size_t last = replay.size() - 1;
+    size_t position = 0;
+    size_t shown = SIZE_MAX;
+    bool playing = false;
+    bool redraw = true;
+    bool running = true;
+    SystemStats stats{};
+    int64_t time_ms = 0;
+    
+    while (running) {
+        if (redraw) {
+            if (position != shown) {
+                if (!replay.read(position, stats, time_ms)) {
+                    display.leave();
+                    std::cerr << "\nError: recording is damaged at sample " << position + 1 << "\n";
+                    return 1;
+                }
+                shown = position;
+            }
+            
+            char when[32];
+            time_t seconds = static_cast<time_t>(time_ms / 1000);
+            struct tm local;
+            localtime_r(&seconds, &local);
+            strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &local);
+            
+            char status[192];
+            std::snprintf(status, sizeof(status),
+                          "[q]uit [space] %s [,/.] step [[/]] %zu [g/G] first/last | %s | %zu/%zu",
+                          playing ? "pause" : "play", jump, when, position + 1, replay.size());
+            display.render(stats, status);
+            redraw = false;
+        }
+        
+        unsigned ready = events.wait();
+        if (ready & EventLoop::QUIT) {
+            break;
+        }
+        if (ready & EventLoop::RESIZE) {
+            display.resize();
+            redraw = true;
+        }
+        if ((ready & EventLoop::TIMER) && playing) {
+            if (position < last) {
+                ++position;
+            } else {
+                playing = false;
+                events.stopTimer();
+            }
+            redraw = true;
+        }
+        
+        char key;
+        while ((key = keyboard.getKey()) != 0) {
+            switch (key) {
+                case 'q':
+                case 'Q':
+                case 27: // ESC
+                    running = false;
+                    break;
+                case ' ':
+                    playing = !playing;
+                    if (playing) events.setInterval(interval);
+                    else events.stopTimer();
+                    break;
+                case '.':
+                case '>':
+                    if (position < last) position++;
+                    break;
+                case ',':
+                case '<':
+                    if (position > 0) position--;
+                    break;
+                case ']':
+                    position = std::min(last, position + jump);
+                    break;
+                case '[':
+                    position = position > jump ? position - jump : 0;
+                    break;
+                case 'g':
+                    position = 0;
+                    break;
+                case 'G':
+                    position = last;
+                    break;
+            }
+            redraw = true;
+        }
+    }
+    
+    display.leave();
+    std::cout << "\n" << std::flush;
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
@@ -330,31 +317,117 @@ int main(int argc, char* argv[]) {
     
     MtopConfig config = parser.getConfig();
     
-    // Настройка обработки сигналов
-    signal(SIGINT, signalHandler);
-    signal(SIGTERM, signalHandler);
+    std::string filter_error;
+    if (!ProcessFilter::validate(config.filter, filter_error)) {
+        std::cerr << "Error: " << filter_error << "\n";
+        return 1;
+    }
+    
+    if (config.scan_backend == MtopConfig::ScanBackend::URING && !IoRing::supported()) {
+        std::cerr << "Warning: io_uring is not available, reading /proc with plain syscalls\n";
+    }
     
-    SystemInfo sysInfo(config);
+    if (!config.replay_file.empty()) {
+        return runReplay(config);
+    }
+    if (!config.serve_address.empty() || config.publish_shared) {
+        if (config.batch_mode || !config.record_file.empty() || (!config.serve_address.empty() && config.publish_shared)) {
+            std::cerr << "Error: --serve and --publish cannot be combined with each other, --batch or --record\n";
+            return 1;
+        }
+        return config.publish_shared ? runPublish(config) : runServe(config);
+    }
+    if (config.batch_mode || !config.record_file.empty()) {
+        return runBatch(config);
+    }
+    
+    // Цикл событий создаётся до потока сборщика: маска сигналов наследуется
+    EventLoop events;
+    Collector collector(config);
+    events.watchWakeup(collector.notifyFd());
+    events.setInterval(config.interval_ms > 0 ? config.interval_ms : config.update_interval * 1000);
     Display display(config);
     KeyboardHandler keyboard;
     
     if (config.show_colors) {
-        std::cout << "\033[1;32mStarting mtop... Press 'h' for help or 'q' to quit\033[0m\n";
+        std::cout << "\033[1;32mStarting mtop... Press 'h' for help or 'q' to quit\033[0m\n" << std::flush;
     } else {
-        std::cout << "Starting mtop... Press 'h' for help or 'q' to quit\n";
+        std::cout << "Starting mtop... Press 'h' for help or 'q' to quit\n" << std::flush;
+    }
+    if (collector.sharedPublisher() != 0) {
+        std::cout << "Using the shared collector (pid " << collector.sharedPublisher() << ")\n" << std::flush;
     }
     std::this_thread::sleep_for(std::chrono::seconds(1));
     
-    bool force_update = true;
-    auto last_update = std::chrono::steady_clock::now();
+    SnapshotPtr snapshot;
+    bool running = true;
+    bool redraw = false;
+    bool editing_filter = false;
+    std::string filter_input;
+    std::string filter_prompt; // строка ввода фильтра, память переиспользуется между кадрами
+    std::string status;
     
     while (running) {
-        // Проверяем клавиши
-        char key = keyboard.getKey();
-        bool config_changed = false;
+        // Спим до клавиши, срока обновления, сигнала или готового снимка
+        unsigned ready = events.wait();
         
-        if (key != 0) {
+        if (ready & EventLoop::QUIT) {
+            break;
+        }
+        if (ready & EventLoop::TIMER) {
+            collector.requestUpdate();
+        }
+        if (ready & EventLoop::RESIZE) {
+            display.resize();
+            redraw = true;
+        }
+        if (collector.poll(snapshot)) {
+            redraw = true;
+        }
+        
+        // Обрабатываем все накопившиеся клавиши
+        bool config_changed = false;
+        char key;
+        while (running && (key = keyboard.getKey()) != 0) {
+            if (editing_filter) {
+                // Строка ввода фильтра: Enter применяет, ESC отменяет
+                if (key == '\n' || key == '\r') {
+                    if (ProcessFilter::validate(filter_input, filter_error)) {
+                        config.filter = filter_input;
+                        config_changed = true;
+                        status.clear();
+                    } else {
+                        status = filter_error;
+                    }
+                    editing_filter = false;
+                } else if (key == 27) {
+                    editing_filter = false;
+                } else if (key == 127 || key == 8) {
+                    // Удаляем последний символ UTF-8 целиком
+                    while (!filter_input.empty() && (static_cast<unsigned char>(filter_input.back()) & 0xC0) == 0x80) {
+                        filter_input.pop_back();
+                    }
+                    if (!filter_input.empty()) filter_input.pop_back();
+                } else if (static_cast<unsigned char>(key) >= 0x20) {
+                    filter_input.push_back(key);
+                }
+                redraw = true;
+                continue;
+            }
+            
+            // Любая клавиша убирает сообщение об ошибке фильтра
+            if (!status.empty()) {
+                status.clear();
+                redraw = true;
+            }
+            
             switch (key) {
+                case 'f':
+                case 'F':
+                    editing_filter = true;
+                    filter_input = config.filter;
+                    redraw = true;
+                    break;
                 case 'q':
                 case 'Q':
                 case 27: // ESC
@@ -387,87 +460,80 @@ int main(int argc, char* argv[]) {
                     break;
                 case '+':
                 case '=':
-                    if (config.update_interval > 1) {
-                        config.update_interval--;
-                        config_changed = true;
-                    }
+                    if (stepInterval(config, true)) config_changed = true;
                     break;
                 case '-':
                 case '_':
-                    if (config.update_interval < 10) {
-                        config.update_interval++;
-                        config_changed = true;
-                    }
+                    if (stepInterval(config, false)) config_changed = true;
                     break;
                 case 't':
                 case 'T':
                     config.show_network_stats = !config.show_network_stats;
                     config_changed = true;
                     break;
-                case 'h':
+                case '1':
+                    config.show_cpu_cores = !config.show_cpu_cores;
+                    config_changed = true;
+                    break;
+                case 'a':
+                case 'A':
+                    config.show_command_line = !config.show_command_line;
+                    config_changed = true;
+                    break;
                 case 'H':
+                    config.show_threads = !config.show_threads;
+                    config_changed = true;
+                    break;
+                case 'u':
+                case 'U':
+                    config.show_memory_detail = !config.show_memory_detail;
+                    config_changed = true;
+                    break;
+                case 'h':
                 case '?':
-                    display.clear();
-                    display.printHeader();
-                    std::cout << "\nKeyboard Commands:\n";
-                    std::cout << "  q, Q, ESC  - Quit\n";
-                    std::cout << "  m, M       - Sort by Memory (default)\n";
-                    std::cout << "  c, C       - Sort by CPU\n";
-                    std::cout << "  p, P       - Sort by PID\n";
-                    std::cout << "  n, N       - Sort by Name\n";
-                    std::cout << "  r, R       - Reverse sort order\n";
-                    std::cout << "  t, T       - Toggle network statistics\n";
-                    std::cout << "  +, =       - Decrease update interval\n";
-                    std::cout << "  -, _       - Increase update interval\n";
-                    std::cout << "  h, H, ?    - Show this help\n\n";
-                    std::cout << "Press any key to continue...";
-                    std::cout.flush();
+                    display.showHelp();
                     
-                    // Ждем нажатия любой клавиши
+                    // Ждем нажатия любой клавиши; сбор тем временем продолжается
                     while (keyboard.getKey() == 0) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                        unsigned help_ready = events.wait();
+                        if (help_ready & EventLoop::QUIT) {
+                            running = false;
+                            break;
+                        }
+                        if (help_ready & EventLoop::TIMER) {
+                            collector.requestUpdate();
+                        }
+                        if (help_ready & EventLoop::RESIZE) {
+                            display.resize();
+                            display.showHelp();
+                        }
+                        if (help_ready & EventLoop::WAKEUP) {
+                            collector.poll(snapshot);
+                        }
                     }
-                    force_update = true;
+                    redraw = true;
                     break;
             }
         }
         
         if (config_changed) {
-            sysInfo.updateConfig(config);
+            collector.updateConfig(config);
             display.updateConfig(config);
-            force_update = true;
+            events.setInterval(config.interval_ms > 0 ? config.interval_ms : config.update_interval * 1000);
         }
         
-        // Проверяем, пора ли обновлять экран
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_update);
-        
-        if (force_update || elapsed.count() >= config.update_interval) {
-            display.clear();
-            display.printHeader();
-            
-            sysInfo.updateStats();
-            SystemStats stats = sysInfo.getStats();
-            
-            display.printSystemStats(stats);
-            display.printProcesses(stats);
-            
-            if (config.show_colors) {
-                std::cout << "\n\033[1;90m[q]uit [m]emory [c]pu [p]id [n]ame [r]everse [+/-] delay [h]elp | Update: " 
-                          << config.update_interval << "s\033[0m" << std::flush;
-            } else {
-                std::cout << "\n[q]uit [m]emory [c]pu [p]id [n]ame [r]everse [+/-] delay [h]elp | Update: " 
-                          << config.update_interval << "s" << std::flush;
+        if (running && redraw && snapshot) {
+            if (editing_filter) {
+                filter_prompt.assign("Filter: ");
+                filter_prompt += filter_input;
+                filter_prompt += '_';
             }
-            
-            last_update = now;
-            force_update = false;
+            display.render(snapshot->stats, editing_filter ? filter_prompt : status);
+            redraw = false;
         }
-        
-        // Небольшая задержка чтобы не загружать CPU
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     
+    display.leave();
     if (config.show_colors) {
         std::cout << "\n\033[1;32mGoodbye!\033[0m\n";
     } else {
@@ -0,0 +1,410 @@
+#include "metrics_server.hpp"
+#include <cerrno>
+#include <ctime>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::string_view OK_HEADER =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+    "Cache-Control: no-store\r\n"
+    "Connection: close\r\n"
+    "Content-Length: ";
+
+constexpr std::string_view BAD_REQUEST =
+    "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+constexpr std::string_view NOT_FOUND =
+    "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 23\r\n"
+    "Connection: close\r\n\r\nTry GET /metrics here.\n";
+
+constexpr std::string_view METHOD_NOT_ALLOWED =
+    "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET, HEAD\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+constexpr std::string_view TOO_LARGE =
+    "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+int64_t monotonicMs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+}
+
+bool watch(int epoll_fd, int fd, uint32_t events, int op) {
+    struct epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    return epoll_ctl(epoll_fd, op, fd, &event) == 0;
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(const MtopConfig& cfg)
+    : config(cfg), epoll_fd(epoll_create1(EPOLL_CLOEXEC)), listen_fd(-1), body(65536) {
+}
+
+MetricsServer::~MetricsServer() {
+    for (auto& entry : clients) {
+        close(entry.first);
+    }
+    if (listen_fd >= 0) close(listen_fd);
+    if (epoll_fd >= 0) close(epoll_fd);
+}
+
+bool MetricsServer::listen(const std::string& address) {
+    if (epoll_fd < 0) return false;
+
+    // Разбираем PORT, :PORT, HOST:PORT и [IPV6]:PORT
+    std::string host;
+    std::string port;
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos) {
+        port = address;
+    } else {
+        host = address.substr(0, colon);
+        port = address.substr(colon + 1);
+        if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        } else if (host.find(':') != std::string::npos) {
+            errno = EINVAL; // IPv6 без скобок неоднозначен
+            return false;
+        }
+    }
+    if (port.empty() || port.find_first_not_of("0123456789") != std::string::npos) {
+        errno = EINVAL;
+        return false;
+    }
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result) != 0) {
+        errno = EADDRNOTAVAIL;
+        return false;
+    }
+
+    // Берём первый адрес, к которому удалось привязаться
+    int saved_errno = EADDRNOTAVAIL;
+    for (struct addrinfo* ai = result; ai && listen_fd < 0; ai = ai->ai_next) {
+        int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            saved_errno = errno;
+            continue;
+        }
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0) {
+            listen_fd = fd;
+        } else {
+            saved_errno = errno;
+            close(fd);
+        }
+    }
+    freeaddrinfo(result);
+
+    if (listen_fd < 0 || !watch(epoll_fd, listen_fd, EPOLLIN, EPOLL_CTL_ADD)) {
+        errno = saved_errno;
+        return false;
+    }
+    return true;
+}
+
+void MetricsServer::publish(const Snapshot& snapshot) {
+    writeMetrics(snapshot);
+
+    // Старый ответ может ещё отправляться: тогда собираем новый в отдельном буфере
+    if (!current || current.use_count() > 1) {
+        current = std::make_shared<Response>();
+    }
+    FrameBuffer& bytes = current->bytes;
+    bytes.clear();
+    bytes.append(OK_HEADER);
+    bytes.appendUnsigned(body.size());
+    bytes.append("\r\n\r\n");
+    current->header_length = bytes.size();
+    bytes.append(body.view());
+}
+
+void MetricsServer::handleEvents() {
+    struct epoll_event events[32];
+    int count;
+    do {
+        count = epoll_wait(epoll_fd, events, 32, 0);
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listen_fd) {
+                acceptClients();
+                continue;
+            }
+
+            auto it = clients.find(fd);
+            if (it == clients.end()) continue;
+            Client& client = *it->second;
+            client.last_active_ms = monotonicMs();
+            if (client.responding) {
+                if (sendPending(fd, client)) closeClient(fd);
+            } else {
+                readRequest(fd, client);
+            }
+        }
+    } while (count == 32);
+}
+
+void MetricsServer::expireIdle() {
+    int64_t now = monotonicMs();
+    for (auto it = clients.begin(); it != clients.end();) {
+        if (now - it->second->last_active_ms > IDLE_TIMEOUT_MS) {
+            close(it->first);
+            it = clients.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MetricsServer::acceptClients() {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return; // EAGAIN или нехватка дескрипторов - попробуем на следующем событии
+        }
+        if (clients.size() >= MAX_CLIENTS || !watch(epoll_fd, fd, EPOLLIN, EPOLL_CTL_ADD)) {
+            close(fd);
+            continue;
+        }
+        auto client = std::make_unique<Client>();
+        client->last_active_ms = monotonicMs();
+        clients.emplace(fd, std::move(client));
+    }
+}
+
+void MetricsServer::readRequest(int fd, Client& client) {
+    // Клиент вроде "nc -N" закрывает свою сторону сразу после запроса,
+    // поэтому конец потока ещё не повод бросать уже пришедший запрос
+    bool eof = false;
+    while (client.received < MAX_REQUEST) {
+        ssize_t n = recv(fd, client.request + client.received, MAX_REQUEST - client.received, 0);
+        if (n > 0) {
+            client.received += static_cast<size_t>(n);
+            continue;
+        }
+        if (n == 0) {
+            eof = true;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        closeClient(fd); // соединение разорвано
+        return;
+    }
+
+    // Отвечаем, как только пришли все заголовки; тело запроса не нужно
+    std::string_view request(client.request, client.received);
+    if (request.find("\r\n\r\n") != std::string_view::npos || request.find("\n\n") != std::string_view::npos) {
+        respond(fd, client);
+    } else if (eof) {
+        closeClient(fd); // клиент ушёл, не дослав запрос
+    } else if (client.received == MAX_REQUEST) {
+        client.pending = TOO_LARGE;
+        client.responding = true;
+        if (sendPending(fd, client)) {
+            closeClient(fd);
+        } else {
+            watch(epoll_fd, fd, EPOLLOUT, EPOLL_CTL_MOD);
+        }
+    }
+}
+
+void MetricsServer::respond(int fd, Client& client) {
+    std::string_view request(client.request, client.received);
+    std::string_view line = request.substr(0, request.find('\n'));
+    size_t method_end = line.find(' ');
+    size_t target_end = method_end == std::string_view::npos ? method_end : line.find(' ', method_end + 1);
+
+    if (target_end == std::string_view::npos) {
+        client.pending = BAD_REQUEST;
+    } else {
+        std::string_view method = line.substr(0, method_end);
+        std::string_view target = line.substr(method_end + 1, target_end - method_end - 1);
+        target = target.substr(0, target.find('?'));
+
+        if (method != "GET" && method != "HEAD") {
+            client.pending = METHOD_NOT_ALLOWED;
+        } else if (target != "/metrics" && target != "/") {
+            client.pending = NOT_FOUND;
+        } else if (!current) {
+            client.pending = NOT_FOUND;
+        } else {
+            // Все клиенты отправляют один и тот же готовый буфер
+            client.response = current;
+            client.pending = current->bytes.view();
+            if (method == "HEAD") client.pending = client.pending.substr(0, current->header_length);
+        }
+    }
+
+    client.responding = true;
+    if (sendPending(fd, client)) {
+        closeClient(fd);
+    } else {
+        watch(epoll_fd, fd, EPOLLOUT, EPOLL_CTL_MOD);
+    }
+}
+
+bool MetricsServer::sendPending(int fd, Client& client) {
+    while (!client.pending.empty()) {
+        ssize_t n = send(fd, client.pending.data(), client.pending.size(), MSG_NOSIGNAL);
+        if (n > 0) {
+            client.pending.remove_prefix(static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return false;
+        return true; // соединение разорвано - закрываем
+    }
+    return true;
+}
+
+void MetricsServer::closeClient(int fd) {
+    close(fd);
+    clients.erase(fd);
+}
+
+void MetricsServer::writeMetrics(const Snapshot& snapshot) {
+    const SystemStats& stats = snapshot.stats;
+    body.clear();
+
+    beginFamily("mtop_cpu_usage_percent", "gauge", "CPU time in use since the previous sample, all cores.");
+    body.append("mtop_cpu_usage_percent ");
+    body.appendFixed(stats.cpu_percent, 1);
+    body.append('\n');
+
+    if (!stats.cpu_cores.empty()) {
+        beginFamily("mtop_cpu_core_usage_percent", "gauge", "CPU time in use since the previous sample, per core.");
+        for (size_t i = 0; i < stats.cpu_cores.size(); ++i) {
+            body.append("mtop_cpu_core_usage_percent{core=\"");
+            body.appendUnsigned(i);
+            body.append("\"} ");
+            body.appendFixed(stats.cpu_cores[i].total, 1);
+            body.append('\n');
+        }
+    }
+
+    beginFamily("mtop_memory_total_bytes", "gauge", "Total usable memory.");
+    body.append("mtop_memory_total_bytes ");
+    body.appendUnsigned(stats.total_memory_kb * 1024);
+    body.append('\n');
+    beginFamily("mtop_memory_used_bytes", "gauge", "Memory in use (total minus available).");
+    body.append("mtop_memory_used_bytes ");
+    body.appendUnsigned(stats.used_memory_kb * 1024);
+    body.append('\n');
+    beginFamily("mtop_memory_available_bytes", "gauge", "Memory available for new allocations.");
+    body.append("mtop_memory_available_bytes ");
+    body.appendUnsigned(stats.free_memory_kb * 1024);
+    body.append('\n');
+
+    static constexpr std::string_view LOAD_NAMES[] = {"mtop_load1", "mtop_load5", "mtop_load15"};
+    static constexpr std::string_view LOAD_HELP[] = {"1-minute load average.", "5-minute load average.",
+                                                     "15-minute load average."};
+    for (int i = 0; i < 3; ++i) {
+        beginFamily(LOAD_NAMES[i], "gauge", LOAD_HELP[i]);
+        body.append(LOAD_NAMES[i]);
+        body.append(' ');
+        body.appendFixed(stats.load_avg[i], 2);
+        body.append('\n');
+    }
+
+    beginFamily("mtop_processes", "gauge", "Number of processes.");
+    body.append("mtop_processes ");
+    body.appendInt(stats.process_count);
+    body.append('\n');
+
+    if (config.show_network_stats && !stats.network_interfaces.empty()) {
+        struct Counter {
+            std::string_view name;
+            std::string_view help;
+            uint64_t NetworkStats::*field;
+        };
+        static const Counter NETWORK_COUNTERS[] = {
+            {"mtop_network_receive_bytes", "Bytes received.", &NetworkStats::rx_bytes},
+            {"mtop_network_transmit_bytes", "Bytes sent.", &NetworkStats::tx_bytes},
+            {"mtop_network_receive_packets", "Packets received.", &NetworkStats::rx_packets},
+            {"mtop_network_transmit_packets", "Packets sent.", &NetworkStats::tx_packets},
+        };
+        for (const auto& counter : NETWORK_COUNTERS) {
+            beginFamily(counter.name, "counter", counter.help);
+            for (const auto& net : stats.network_interfaces) {
+                body.append(counter.name);
+                body.append("_total{interface=\"");
+                appendLabelValue(net.interface);
+                body.append("\"} ");
+                body.appendUnsigned(net.*counter.field);
+                body.append('\n');
+            }
+        }
+    }
+
+    // Процессы - те же строки, что показывает таблица (сортировка, фильтры, --max-processes)
+    beginFamily("mtop_process_cpu_usage_percent", "gauge", "CPU usage of listed processes.");
+    for (const auto& proc : stats.processes) {
+        body.append("mtop_process_cpu_usage_percent{pid=\"");
+        body.appendInt(proc.pid);
+        body.append("\",name=\"");
+        appendLabelValue(proc.name);
+        body.append("\",user=\"");
+        appendLabelValue(proc.user);
+        body.append("\"} ");
+        body.appendFixed(proc.cpu_percent, 1);
+        body.append('\n');
+    }
+    beginFamily("mtop_process_resident_bytes", "gauge", "Resident memory of listed processes.");
+    for (const auto& proc : stats.processes) {
+        body.append("mtop_process_resident_bytes{pid=\"");
+        body.appendInt(proc.pid);
+        body.append("\",name=\"");
+        appendLabelValue(proc.name);
+        body.append("\",user=\"");
+        appendLabelValue(proc.user);
+        body.append("\"} ");
+        body.appendUnsigned(proc.memory_kb * 1024);
+        body.append('\n');
+    }
+
+    beginFamily("mtop_collections", "counter", "Samples taken since mtop started.");
+    body.append("mtop_collections_total ");
+    body.appendUnsigned(snapshot.sequence);
+    body.append("\n# EOF\n");
+}
+
+void MetricsServer::beginFamily(std::string_view name, std::string_view type, std::string_view help) {
+    body.append("# TYPE ");
+    body.append(name);
+    body.append(' ');
+    body.append(type);
+    body.append("\n# HELP ");
+    body.append(name);
+    body.append(' ');
+    body.append(help);
+    body.append('\n');
+}
+
+void MetricsServer::appendLabelValue(std::string_view text) {
+    // В значениях меток экранируются только \, " и перевод строки
+    for (char c : text) {
+        if (c == '\\' || c == '"') {
+            body.append('\\');
+            body.append(c);
+        } else if (c == '\n') {
+            body.append("\\n");
+        } else {
+            body.append(c);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef METRICS_SERVER_HPP
+#define METRICS_SERVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "system_info.hpp"
+#include "frame_buffer.hpp"
+#include "parser.hpp"
+
+// Minimal HTTP/1.1 listener for --serve. GET /metrics returns the latest
+// sample in OpenMetrics text format. The response (headers and body) is
+// serialized once per collection in publish() and shared by every client,
+// so any number of concurrent scrapers costs one /proc walk per interval.
+// Each connection answers one request and is closed.
+//
+// All sockets live in a private epoll set; fd() is that epoll descriptor,
+// which becomes readable whenever a socket needs attention. Hand it to
+// EventLoop::watchWakeup() and call handleEvents() on WAKEUP.
+class MetricsServer {
+public:
+    explicit MetricsServer(const MtopConfig& config);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // address is PORT, :PORT, HOST:PORT or [IPV6]:PORT.
+    // On failure errno describes the problem (EINVAL: malformed address).
+    bool listen(const std::string& address);
+
+    int fd() const { return epoll_fd; }
+
+    // Serialize a new sample; clients already being served keep the old one
+    void publish(const Snapshot& snapshot);
+
+    // Accept, read and write whatever is ready without blocking
+    void handleEvents();
+
+    // Drop connections that have been silent for too long
+    void expireIdle();
+
+    static constexpr size_t MAX_CLIENTS = 64;
+    static constexpr size_t MAX_REQUEST = 4096;
+    static constexpr int64_t IDLE_TIMEOUT_MS = 10000;
+
+private:
+    struct Response {
+        FrameBuffer bytes{65536};
+        size_t header_length = 0;
+    };
+
+    struct Client {
+        char request[MAX_REQUEST];
+        size_t received = 0;
+        std::shared_ptr<const Response> response; // keeps the bytes alive while sending
+        std::string_view pending;                 // what is left to send
+        bool responding = false;
+        int64_t last_active_ms = 0;
+    };
+
+    MtopConfig config;
+    int epoll_fd;
+    int listen_fd;
+    std::unordered_map<int, std::unique_ptr<Client>> clients;
+    std::shared_ptr<Response> current;
+    FrameBuffer body;
+
+    void acceptClients();
+    void readRequest(int fd, Client& client);
+    void respond(int fd, Client& client);
+    bool sendPending(int fd, Client& client);
+    void closeClient(int fd);
+
+    void writeMetrics(const Snapshot& snapshot);
+    void beginFamily(std::string_view name, std::string_view type, std::string_view help);
+    void appendLabelValue(std::string_view text);
+};
+
+#endif // METRICS_SERVER_HPP
@@ -0,0 +1,70 @@
+#include "proc_dir.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// Запись, которую возвращает getdents64 (в glibc нет её объявления)
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1]; // фактическая длина определяется d_reclen
+};
+
+// Разбирает имя как PID прямо в буфере; false если имя не число
+inline bool parseId(const char* name, int& id) {
+    if (*name < '0' || *name > '9') return false;
+
+    int value = 0;
+    for (; *name; ++name) {
+        if (*name < '0' || *name > '9') return false;
+        value = value * 10 + (*name - '0');
+    }
+    id = value;
+    return true;
+}
+
+} // namespace
+
+PidEnumerator::PidEnumerator() : buffer(BUFFER_SIZE) {
+}
+
+bool PidEnumerator::scan(const char* path) {
+    result.clear();
+
+    int fd = ::open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    while (true) {
+        long n = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        if (n <= 0) break;
+
+        for (long offset = 0; offset < n;) {
+            const auto* entry = reinterpret_cast<const LinuxDirent64*>(buffer.data() + offset);
+            offset += entry->d_reclen;
+
+            // В /proc тип известен всегда, DT_UNKNOWN оставлен для других файловых систем
+            if (entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN) continue;
+
+            int id;
+            if (parseId(entry->d_name, id)) {
+                result.push_back(id);
+            }
+        }
+    }
+
+    ::close(fd);
+    return true;
+}
+
+bool PidEnumerator::scanTasks(int pid) {
+    char path[40];
+    std::snprintf(path, sizeof(path), "/proc/%d/task", pid);
+    return scan(path);
+}
@@ -0,0 +1,30 @@
+#ifndef PROC_DIR_HPP
+#define PROC_DIR_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Enumerates numeric entries of /proc-style directories with getdents64.
+// Works for /proc itself and for /proc/PID/task; the result is a packed
+// array of ids that stays valid until the next scan.
+class PidEnumerator {
+public:
+    PidEnumerator();
+    ~PidEnumerator() = default;
+
+    // Scan a directory and collect all numeric subdirectories
+    bool scan(const char* path);
+
+    // Scan /proc/PID/task
+    bool scanTasks(int pid);
+
+    const std::vector<int>& ids() const { return result; }
+
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+private:
+    std::vector<char> buffer;
+    std::vector<int> result;
+};
+
+#endif // PROC_DIR_HPP
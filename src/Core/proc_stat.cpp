@@ -0,0 +1,378 @@
+#include "proc_stat.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Номера полей после закрывающей скобки (state = 0)
+constexpr int FIELD_PPID = 1;
+constexpr int FIELD_UTIME = 11;
+constexpr int FIELD_STIME = 12;
+constexpr int FIELD_STARTTIME = 19;
+constexpr int FIELD_RSS = 21;
+
+// Дескрипторы, которые оставляем свободными для остальной программы
+constexpr size_t RESERVED_FDS = 64;
+
+// Читает беззнаковое число и сдвигает указатель на следующий разделитель
+inline bool parseUnsigned(const char*& p, const char* end, uint64_t& value) {
+    if (p >= end || *p < '0' || *p > '9') return false;
+
+    uint64_t result = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        result = result * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    value = result;
+    return true;
+}
+
+inline void skipSpaces(const char*& p, const char* end) {
+    while (p < end && *p == ' ') ++p;
+}
+
+inline void skipField(const char*& p, const char* end) {
+    while (p < end && *p != ' ' && *p != '\n') ++p;
+}
+
+} // namespace
+
+bool parseProcStat(const char* data, size_t len, ProcStat& out) {
+    const char* end = data + len;
+
+    // Имя процесса может содержать пробелы и скобки, поэтому ищем
+    // первую '(' с начала и последнюю ')' с конца строки
+    const char* open_paren = static_cast<const char*>(std::memchr(data, '(', len));
+    if (!open_paren) return false;
+
+    const char* close_paren = end;
+    while (close_paren > open_paren && *--close_paren != ')') {
+    }
+    if (close_paren == open_paren) return false;
+
+    out.comm = open_paren + 1;
+    out.comm_len = static_cast<size_t>(close_paren - open_paren - 1);
+
+    const char* p = close_paren + 1;
+    skipSpaces(p, end);
+    if (p >= end) return false;
+    out.state = *p++;
+
+    for (int field = 1; field <= FIELD_RSS; ++field) {
+        skipSpaces(p, end);
+        if (p >= end) return false;
+
+        uint64_t value = 0;
+        switch (field) {
+            case FIELD_PPID:
+                if (!parseUnsigned(p, end, value)) return false;
+                out.ppid = static_cast<int>(value);
+                break;
+            case FIELD_UTIME:
+                if (!parseUnsigned(p, end, out.utime)) return false;
+                break;
+            case FIELD_STIME:
+                if (!parseUnsigned(p, end, out.stime)) return false;
+                break;
+            case FIELD_STARTTIME:
+                if (!parseUnsigned(p, end, out.start_time)) return false;
+                break;
+            case FIELD_RSS:
+                if (!parseUnsigned(p, end, out.rss_pages)) return false;
+                break;
+            default:
+                skipField(p, end);
+                break;
+        }
+    }
+
+    return true;
+}
+
+ProcStatReader::ProcStatReader(int max_cached_fds, size_t shard_count)
+    : generation(0), fd_budget(0), syscall_count(0), retired_enters(0), prefetch_next(0) {
+    setFdBudget(max_cached_fds, shard_count);
+}
+
+ProcStatReader::~ProcStatReader() {
+    discardPrefetched();
+    for (const auto& entry : cache) {
+        ::close(entry.second.fd);
+    }
+}
+
+void ProcStatReader::setFdBudget(int max_cached_fds, size_t shard_count) {
+    // Бюджет никогда не превышает мягкий лимит RLIMIT_NOFILE за вычетом резерва
+    size_t limit = 0;
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY) {
+        limit = rl.rlim_cur > RESERVED_FDS ? static_cast<size_t>(rl.rlim_cur) - RESERVED_FDS : 0;
+    } else {
+        limit = 65536;
+    }
+
+    fd_budget = max_cached_fds > 0 ? std::min(static_cast<size_t>(max_cached_fds), limit) : limit;
+    if (shard_count > 1) {
+        fd_budget /= shard_count;
+    }
+
+    while (cache.size() > fd_budget) {
+        evict(cache.begin());
+    }
+}
+
+void ProcStatReader::beginScan() {
+    ++generation;
+}
+
+void ProcStatReader::endScan() {
+    discardPrefetched();
+    
+    // Закрываем дескрипторы процессов, которые не встретились в этом проходе
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (it->second.generation != generation) {
+            ::close(it->second.fd);
+            ++syscall_count;
+            it = cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool ProcStatReader::read(int pid, ProcStat& out, ProcOwner* owner) {
+    // Процесс из предвыборки: его stat уже прочитан пачкой
+    if (prefetch_next < prefetched.size() && prefetched[prefetch_next].pid == pid) {
+        return readPrefetched(prefetch_next++, out, owner);
+    }
+    return readCached(pid, 0, out, owner);
+}
+
+bool ProcStatReader::readTask(int tgid, int tid, ProcStat& out) {
+    return readCached(tgid, tid, out, nullptr);
+}
+
+bool ProcStatReader::readCached(int pid, int tid, ProcStat& out, ProcOwner* owner) {
+    // /proc/PID/stat суммирует все потоки, поэтому поток читаем только из task/
+    const int key = tid > 0 ? tid : pid;
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        if (readFrom(it->second.fd, out, owner) && out.start_time == it->second.start_time) {
+            it->second.generation = generation;
+            return true;
+        }
+        // Ошибка чтения (процесс завершился или дескриптор испорчен) или
+        // PID переиспользован другим процессом - открываем заново
+        evict(it);
+    }
+
+    int fd = openStat(pid, tid);
+    if (fd < 0) return false;
+
+    if (!readFrom(fd, out, owner)) {
+        ::close(fd);
+        ++syscall_count;
+        return false;
+    }
+
+    cacheOpened(key, fd, out.start_time);
+    return true;
+}
+
+void ProcStatReader::prefetch(const int* pids, size_t count) {
+    discardPrefetched();
+    if (!ring || count == 0) return;
+    count = std::min(count, BATCH_SIZE);
+
+    // Первый круг: openat для процессов без кэшированного дескриптора
+    size_t opens = 0;
+    for (size_t i = 0; i < count; ++i) {
+        auto it = cache.find(pids[i]);
+        if (it != cache.end()) {
+            prefetched.push_back(Prefetched{pids[i], it->second.fd, 0, false});
+            continue;
+        }
+        char* path = open_paths.data() + i * PATH_SIZE;
+        std::snprintf(path, PATH_SIZE, "/proc/%d/stat", pids[i]);
+        ring->prepareOpenat(path, O_RDONLY | O_CLOEXEC, i);
+        prefetched.push_back(Prefetched{pids[i], -1, 0, true});
+        ++opens;
+    }
+
+    uint64_t index;
+    int result;
+    if (opens > 0) {
+        if (!ring->submitAndWait()) {
+            dropRing();
+            return;
+        }
+        while (ring->nextCompletion(index, result)) {
+            if (index < prefetched.size()) prefetched[index].fd = result >= 0 ? result : -1;
+        }
+    }
+
+    // Второй круг: чтение всех файлов пачки одним вызовом
+    for (size_t i = 0; i < prefetched.size(); ++i) {
+        if (prefetched[i].fd >= 0) {
+            ring->prepareRead(prefetched[i].fd, slots.data() + i * SLOT_SIZE, SLOT_SIZE, 0, i);
+        }
+    }
+    if (!ring->submitAndWait()) {
+        dropRing();
+        return;
+    }
+    while (ring->nextCompletion(index, result)) {
+        if (index < prefetched.size()) prefetched[index].length = result;
+    }
+}
+
+bool ProcStatReader::readPrefetched(size_t index, ProcStat& out, ProcOwner* owner) {
+    Prefetched& entry = prefetched[index];
+    if (entry.fd < 0) return false; // процесс завершился до openat
+
+    // Заполненный до конца слот мог обрезать строку - такую перечитываем целиком
+    const char* data = slots.data() + index * SLOT_SIZE;
+    bool parsed = entry.length > 0 && static_cast<size_t>(entry.length) < SLOT_SIZE &&
+                  parseProcStat(data, static_cast<size_t>(entry.length), out);
+    if (!parsed && entry.length == static_cast<int>(SLOT_SIZE)) {
+        parsed = readFrom(entry.fd, out, nullptr);
+    }
+
+    if (parsed && owner) {
+        struct stat st;
+        ++syscall_count;
+        parsed = fstat(entry.fd, &st) == 0;
+        if (parsed) {
+            owner->uid = st.st_uid;
+            owner->gid = st.st_gid;
+        }
+    }
+
+    if (entry.opened) {
+        int fd = entry.fd;
+        entry.fd = -1; // дескриптор больше не принадлежит пачке
+        if (!parsed) {
+            ::close(fd);
+            ++syscall_count;
+            return false;
+        }
+        cacheOpened(entry.pid, fd, out.start_time);
+        return true;
+    }
+
+    auto it = cache.find(entry.pid);
+    if (parsed && it != cache.end() && it->second.start_time == out.start_time) {
+        it->second.generation = generation;
+        return true;
+    }
+
+    // Ошибка чтения или PID переиспользован - открываем заново обычным путём
+    if (it != cache.end()) evict(it);
+    return readCached(entry.pid, 0, out, owner);
+}
+
+void ProcStatReader::cacheOpened(int pid, int fd, uint64_t start_time) {
+    if (cache.size() < fd_budget) {
+        cache.emplace(pid, CachedFd{fd, start_time, generation});
+    } else {
+        ::close(fd);
+        ++syscall_count;
+    }
+}
+
+bool ProcStatReader::useRing(bool enable) {
+    if (!enable) {
+        dropRing();
+        return true;
+    }
+    if (ring) return true;
+
+    auto candidate = std::make_unique<IoRing>();
+    if (!candidate->setup(static_cast<unsigned>(BATCH_SIZE))) return false;
+    ring = std::move(candidate);
+    slots.resize(BATCH_SIZE * SLOT_SIZE);
+    open_paths.resize(BATCH_SIZE * PATH_SIZE);
+    return true;
+}
+
+void ProcStatReader::dropRing() {
+    // Кольцо отказало или больше не нужно: дальше читаем синхронно
+    discardPrefetched();
+    if (ring) {
+        retired_enters += ring->enterCalls();
+        ring.reset();
+    }
+}
+
+void ProcStatReader::discardPrefetched() {
+    // Дескрипторы, открытые пачкой, но так и не прочитанные, закрываем
+    for (size_t i = prefetch_next; i < prefetched.size(); ++i) {
+        if (prefetched[i].opened && prefetched[i].fd >= 0) {
+            ::close(prefetched[i].fd);
+            ++syscall_count;
+        }
+    }
+    prefetched.clear();
+    prefetch_next = 0;
+}
+
+bool ProcStatReader::readOwner(int pid, uint64_t start_time, ProcOwner& owner) const {
+    struct stat st;
+    ++syscall_count;
+    auto it = cache.find(pid);
+    if (it != cache.end() && it->second.start_time == start_time) {
+        if (fstat(it->second.fd, &st) != 0) return false;
+    } else {
+        // Дескриптор не кэширован: владелец каталога тот же, что и у файла stat
+        char path[32];
+        std::snprintf(path, sizeof(path), "/proc/%d", pid);
+        if (::stat(path, &st) != 0) return false;
+    }
+    owner.uid = st.st_uid;
+    owner.gid = st.st_gid;
+    return true;
+}
+
+int ProcStatReader::openStat(int pid, int tid) const {
+    char path[48];
+    if (tid > 0) {
+        std::snprintf(path, sizeof(path), "/proc/%d/task/%d/stat", pid, tid);
+    } else {
+        std::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    }
+    ++syscall_count;
+    return ::open(path, O_RDONLY | O_CLOEXEC);
+}
+
+bool ProcStatReader::readFrom(int fd, ProcStat& out, ProcOwner* owner) {
+    ssize_t n;
+    do {
+        n = ::pread(fd, buffer, BUFFER_SIZE - 1, 0);
+        ++syscall_count;
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return false;
+
+    buffer[n] = '\0';
+    if (!parseProcStat(buffer, static_cast<size_t>(n), out)) return false;
+
+    if (owner) {
+        struct stat st;
+        ++syscall_count;
+        if (fstat(fd, &st) != 0) return false;
+        owner->uid = st.st_uid;
+        owner->gid = st.st_gid;
+    }
+    return true;
+}
+
+void ProcStatReader::evict(std::unordered_map<int, CachedFd>::iterator it) {
+    ::close(it->second.fd);
+    ++syscall_count;
+    cache.erase(it);
+}
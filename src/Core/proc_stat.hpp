@@ -0,0 +1,131 @@
+#ifndef PROC_STAT_HPP
+#define PROC_STAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "io_ring.hpp"
+
+// Fields of /proc/PID/stat that mtop actually uses.
+// comm points into the reader's buffer and is valid until the next read.
+struct ProcStat {
+    const char* comm;
+    size_t comm_len;
+    char state;
+    int ppid;
+    uint64_t utime;
+    uint64_t stime;
+    uint64_t start_time;
+    uint64_t rss_pages;
+};
+
+// Owner of /proc/PID, i.e. the effective uid/gid of the task
+// (root for non-dumpable processes, the same rule ps and htop follow)
+struct ProcOwner {
+    uint32_t uid;
+    uint32_t gid;
+};
+
+// Parse a raw /proc/PID/stat line without allocating.
+// Handles process names containing spaces and parentheses.
+bool parseProcStat(const char* data, size_t len, ProcStat& out);
+
+// Reads /proc/PID/stat into a reusable buffer.
+// Descriptors of live processes are kept open between scans and re-read
+// with pread(), so a long-lived process costs one syscall per tick.
+//
+// With an io_uring attached, prefetch() reads the stat files of a batch of
+// processes in one io_uring_enter() (two when some need opening first);
+// read() then parses those results instead of issuing its own syscalls.
+class ProcStatReader {
+public:
+    explicit ProcStatReader(int max_cached_fds = 0, size_t shard_count = 1);
+    ~ProcStatReader();
+
+    ProcStatReader(const ProcStatReader&) = delete;
+    ProcStatReader& operator=(const ProcStatReader&) = delete;
+
+    // Read and parse the stat file of the given process.
+    // When owner is given it is filled with fstat() on the same descriptor.
+    bool read(int pid, ProcStat& out, ProcOwner* owner = nullptr);
+
+    // Same for one thread: /proc/TGID/task/TID/stat. Thread descriptors are
+    // cached by TID, so a reader should serve either processes or threads.
+    bool readTask(int tgid, int tid, ProcStat& out);
+
+    // Batch the reads of the next processes through io_uring; read() must
+    // then be called for them in the same order. Does nothing without a ring.
+    void prefetch(const int* pids, size_t count);
+
+    // Switch between io_uring batches and plain syscalls. false if io_uring
+    // was asked for but is unavailable; the reader stays synchronous then.
+    bool useRing(bool enable);
+    bool usingRing() const { return ring != nullptr; }
+
+    // Owner of a process read earlier in this scan: fstat() on its cached
+    // descriptor, or stat() of /proc/PID when it is not cached
+    bool readOwner(int pid, uint64_t start_time, ProcOwner& owner) const;
+
+    // Scan bracketing: descriptors not used since beginScan() are closed by endScan()
+    void beginScan();
+    void endScan();
+
+    // Limit the number of cached descriptors (0 = derive from RLIMIT_NOFILE).
+    // The budget is split evenly when several readers scan in parallel.
+    void setFdBudget(int max_cached_fds, size_t shard_count = 1);
+
+    // Descriptors kept open for the next scan
+    size_t cachedCount() const { return cache.size(); }
+
+    // System calls made for stat files so far (io_uring_enter counts as one)
+    uint64_t syscalls() const { return syscall_count + (ring ? ring->enterCalls() : 0) + retired_enters; }
+
+    static constexpr size_t BUFFER_SIZE = 4096;
+
+    // Processes per io_uring batch and bytes read for each of them; a stat
+    // line is a few hundred bytes, a longer one is re-read with pread()
+    static constexpr size_t BATCH_SIZE = 256;
+    static constexpr size_t SLOT_SIZE = 1024;
+    static constexpr size_t PATH_SIZE = 32;
+
+private:
+    struct CachedFd {
+        int fd;
+        uint64_t start_time;
+        uint64_t generation;
+    };
+
+    // Результат предвыборки одного процесса
+    struct Prefetched {
+        int pid;
+        int fd;     // -1, если открыть не удалось
+        int length; // прочитано байт или -errno
+        bool opened; // дескриптор открыт в этой пачке, в кэше его нет
+    };
+
+    char buffer[BUFFER_SIZE];
+    std::unordered_map<int, CachedFd> cache;
+    uint64_t generation;
+    size_t fd_budget;
+    mutable uint64_t syscall_count;
+    uint64_t retired_enters;
+
+    std::unique_ptr<IoRing> ring;
+    std::vector<Prefetched> prefetched;
+    size_t prefetch_next;
+    std::vector<char> slots;        // BATCH_SIZE * SLOT_SIZE байт под прочитанное
+    std::vector<char> open_paths;   // пути для openat, живут до отправки пачки
+
+    int openStat(int pid, int tid) const; // tid 0 - файл всего процесса
+    bool readCached(int pid, int tid, ProcStat& out, ProcOwner* owner);
+    bool readFrom(int fd, ProcStat& out, ProcOwner* owner);
+    bool readPrefetched(size_t index, ProcStat& out, ProcOwner* owner);
+    void cacheOpened(int pid, int fd, uint64_t start_time);
+    void dropRing();
+    void discardPrefetched();
+    void evict(std::unordered_map<int, CachedFd>::iterator it);
+};
+
+#endif // PROC_STAT_HPP
@@ -0,0 +1,737 @@
+#include "process_filter.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include "identity_cache.hpp"
+
+namespace {
+
+// Глубже этого стек вычисления не бывает у разумных выражений
+constexpr size_t MAX_STACK = 64;
+
+// Предел вложенности скобок и "not" при разборе: рекурсивный спуск не
+// должен исчерпать стек потока на выражении вроде "((((...". Проверка
+// MAX_STACK идёт уже после разбора и от этого не спасает
+constexpr size_t MAX_NESTING = 256;
+
+// Идентификаторы меньше этого хранятся битами, остальные - отсортированным списком
+constexpr uint32_t BITSET_LIMIT = 1u << 20;
+
+bool isWordChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '-' || c == '@' ||
+           c == '+' || c == ':' || c == '%';
+}
+
+bool parseInteger(std::string_view text, int64_t& value) {
+    if (text.empty()) return false;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Число с необязательной дробной частью: "12", "0.5"
+bool parseDecimal(std::string_view text, double& value, std::string_view& rest) {
+    size_t i = 0;
+    while (i < text.size() && std::isdigit(static_cast<unsigned char>(text[i]))) ++i;
+    size_t digits = i;
+    if (i < text.size() && text[i] == '.') {
+        ++i;
+        while (i < text.size() && std::isdigit(static_cast<unsigned char>(text[i]))) ++i;
+    }
+    if (digits == 0 && i <= 1) return false;
+
+    value = 0.0;
+    double scale = 0.0;
+    for (size_t j = 0; j < i; ++j) {
+        if (text[j] == '.') {
+            scale = 1.0;
+            continue;
+        }
+        value = value * 10.0 + (text[j] - '0');
+        scale *= 10.0;
+    }
+    if (scale > 0.0) value /= scale;
+    rest = text.substr(i);
+    return true;
+}
+
+// Размер в байтах: 512, 64K, 1.5G, 2GiB, 10MB
+bool parseSize(std::string_view text, double& bytes) {
+    std::string_view unit;
+    if (!parseDecimal(text, bytes, unit)) return false;
+    if (unit.empty() || unit == "B" || unit == "b") return true;
+
+    static constexpr char UNITS[] = "KMGT";
+    char first = static_cast<char>(std::toupper(static_cast<unsigned char>(unit[0])));
+    const char* found = std::char_traits<char>::find(UNITS, 4, first);
+    if (!found) return false;
+    std::string_view suffix = unit.substr(1);
+    if (!suffix.empty() && suffix != "B" && suffix != "iB" && suffix != "b") return false;
+
+    bytes *= std::pow(1024.0, static_cast<double>(found - UNITS + 1));
+    return true;
+}
+
+// Числовые имена - это сами id; остальные разрешает общий кэш учётных записей
+bool lookupUser(IdentityCache& identities, const std::string& name, uint32_t& uid) {
+    int64_t number;
+    if (parseInteger(name, number) && number >= 0) {
+        uid = static_cast<uint32_t>(number);
+        return true;
+    }
+    return identities.userId(name, uid);
+}
+
+bool lookupGroup(IdentityCache& identities, const std::string& name, uint32_t& gid) {
+    int64_t number;
+    if (parseInteger(name, number) && number >= 0) {
+        gid = static_cast<uint32_t>(number);
+        return true;
+    }
+    return identities.groupId(name, gid);
+}
+
+} // namespace
+
+struct ProcessFilter::Predicate {
+    enum class Field : uint8_t { PID, PPID, UID, GID, RSS, CPU, STATE, NAME, KERNEL };
+    enum class Test : uint8_t { EQ, LT, LE, GT, GE, IN_IDS, IN_STATES, NAME };
+
+    Field field;
+    Test test;
+    FilterStage stage;
+    double number;      // EQ..GE; rss in bytes, cpu in percent
+    uint32_t index;     // IN_IDS: id_sets, NAME: matchers
+    uint64_t states[2]; // IN_STATES: bit per ASCII letter
+};
+
+struct ProcessFilter::IdSet {
+    std::vector<uint64_t> bits;
+    std::vector<int64_t> large; // sorted
+
+    void add(int64_t id) {
+        if (id >= 0 && id < static_cast<int64_t>(BITSET_LIMIT)) {
+            size_t word = static_cast<size_t>(id) / 64;
+            if (bits.size() <= word) bits.resize(word + 1, 0);
+            bits[word] |= uint64_t(1) << (id % 64);
+        } else {
+            large.insert(std::upper_bound(large.begin(), large.end(), id), id);
+        }
+    }
+
+    bool contains(int64_t id) const {
+        if (id >= 0 && id < static_cast<int64_t>(BITSET_LIMIT)) {
+            size_t word = static_cast<size_t>(id) / 64;
+            return word < bits.size() && (bits[word] >> (id % 64) & 1);
+        }
+        return std::binary_search(large.begin(), large.end(), id);
+    }
+};
+
+struct ProcessFilter::NameMatcher {
+    enum class Kind : uint8_t { EXACT, PREFIX, SUFFIX, CONTAINS, REGEX };
+
+    Kind kind = Kind::EXACT;
+    std::vector<std::string> literals; // EXACT: sorted set, PREFIX/SUFFIX: one entry
+    SubstringMatcher substrings;
+    std::regex regex;
+
+    bool matches(std::string_view name) const {
+        switch (kind) {
+            case Kind::EXACT:
+                return std::binary_search(literals.begin(), literals.end(), name,
+                                          [](std::string_view a, std::string_view b) { return a < b; });
+            case Kind::PREFIX:
+                return name.substr(0, literals[0].size()) == literals[0];
+            case Kind::SUFFIX:
+                return name.size() >= literals[0].size() &&
+                       name.substr(name.size() - literals[0].size()) == literals[0];
+            case Kind::CONTAINS:
+                return substrings.matches(name);
+            case Kind::REGEX:
+                return std::regex_search(name.begin(), name.end(), regex);
+        }
+        return false;
+    }
+};
+
+// Разбор выражения сразу в постфиксную программу, без дерева
+class FilterCompiler {
+public:
+    FilterCompiler(ProcessFilter& filter, IdentityCache& identities, std::string_view text)
+        : filter(filter), identities(identities), text(text), pos(0) {}
+
+    bool compileExpression(std::string& error) {
+        next();
+        if (!parseOr() || (token.kind != Kind::END && !fail("unexpected '" + std::string(token.text) + "'"))) {
+            error = message;
+            return false;
+        }
+        return true;
+    }
+
+    // Выражения из старых настроек собираются теми же средствами
+    void emitHiddenNames(const std::vector<std::string>& patterns) {
+        ProcessFilter::NameMatcher matcher;
+        matcher.kind = ProcessFilter::NameMatcher::Kind::CONTAINS;
+        matcher.substrings.build(patterns);
+        emitName(std::move(matcher));
+        emit(ProcessFilter::Op::NOT);
+    }
+
+    void emitUsers(const std::vector<std::string>& users) {
+        // Неизвестные имена просто не совпадают ни с чем, как и раньше
+        ProcessFilter::IdSet ids;
+        for (const auto& user : users) {
+            uint32_t uid;
+            if (!user.empty() && lookupUser(identities, user, uid)) ids.add(uid);
+        }
+        emitIdSet(Field::UID, std::move(ids));
+    }
+
+    void emitKernel() { emitPredicate(Field::KERNEL, Test::EQ, 1.0); }
+    void emit(ProcessFilter::Op op, uint32_t predicate = 0) { filter.program.push_back({op, predicate}); }
+
+private:
+    using Field = ProcessFilter::Predicate::Field;
+    using Test = ProcessFilter::Predicate::Test;
+
+    enum class Kind { END, WORD, STRING, REGEX, LPAREN, RPAREN, COMMA, NOT, AND, OR, EQ, NE, LT, LE, GT, GE, MATCH, NOMATCH, BAD };
+
+    struct Token {
+        Kind kind;
+        std::string_view text; // для STRING и REGEX - без кавычек и слэшей
+        size_t column;
+    };
+
+    ProcessFilter& filter;
+    IdentityCache& identities;
+    std::string_view text;
+    size_t pos;
+    size_t nesting = 0; // текущая глубина "not" и скобок
+    Token token{Kind::END, {}, 0};
+    std::string message;
+
+    std::vector<size_t> value_columns;
+    size_t operator_column = 0; // где начинались значения последнего parseList/parseValue
+
+    bool fail(const std::string& what, size_t column) {
+        if (message.empty()) message = "filter: " + what + " at column " + std::to_string(column + 1);
+        return false;
+    }
+
+    bool fail(const std::string& what) { return fail(what, token.column); }
+
+    void next() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+        token.column = pos;
+        if (pos >= text.size()) {
+            token = Token{Kind::END, {}, pos};
+            return;
+        }
+
+        char c = text[pos];
+        auto two = [&](char second) { return pos + 1 < text.size() && text[pos + 1] == second; };
+        auto single = [&](Kind kind, size_t length) {
+            token = Token{kind, text.substr(pos, length), pos};
+            pos += length;
+        };
+
+        if (c == '(') return single(Kind::LPAREN, 1);
+        if (c == ')') return single(Kind::RPAREN, 1);
+        if (c == ',') return single(Kind::COMMA, 1);
+        if (c == '&' && two('&')) return single(Kind::AND, 2);
+        if (c == '|' && two('|')) return single(Kind::OR, 2);
+        if (c == '=' && two('=')) return single(Kind::EQ, 2);
+        if (c == '=') return single(Kind::EQ, 1);
+        if (c == '!' && two('=')) return single(Kind::NE, 2);
+        if (c == '!' && two('~')) return single(Kind::NOMATCH, 2);
+        if (c == '!') return single(Kind::NOT, 1);
+        if (c == '<' && two('=')) return single(Kind::LE, 2);
+        if (c == '<') return single(Kind::LT, 1);
+        if (c == '>' && two('=')) return single(Kind::GE, 2);
+        if (c == '>') return single(Kind::GT, 1);
+        if (c == '~') return single(Kind::MATCH, 1);
+
+        if (c == '"' || c == '\'' || c == '/') {
+            // Строка или регулярное выражение до парной кавычки; \/ внутри /.../ допустим
+            size_t start = pos + 1;
+            size_t end = start;
+            while (end < text.size() && text[end] != c) {
+                if (text[end] == '\\' && end + 1 < text.size()) ++end;
+                ++end;
+            }
+            if (end >= text.size()) {
+                token = Token{Kind::BAD, text.substr(pos, 1), pos};
+                pos = text.size();
+                return;
+            }
+            token = Token{c == '/' ? Kind::REGEX : Kind::STRING, text.substr(start, end - start), pos};
+            pos = end + 1;
+            return;
+        }
+
+        if (isWordChar(c)) {
+            // '/' внутри слова (kworker/0:1) не начинает регулярное выражение
+            size_t end = pos;
+            while (end < text.size() && (isWordChar(text[end]) || text[end] == '/')) ++end;
+            token = Token{Kind::WORD, text.substr(pos, end - pos), pos};
+            pos = end;
+            if (token.text == "and") token.kind = Kind::AND;
+            else if (token.text == "or") token.kind = Kind::OR;
+            else if (token.text == "not") token.kind = Kind::NOT;
+            return;
+        }
+
+        single(Kind::BAD, 1);
+    }
+
+    bool parseOr() {
+        if (!parseAnd()) return false;
+        while (token.kind == Kind::OR) {
+            next();
+            if (!parseAnd()) return false;
+            emit(ProcessFilter::Op::OR);
+        }
+        return true;
+    }
+
+    bool parseAnd() {
+        if (!parseUnary()) return false;
+        while (token.kind == Kind::AND) {
+            next();
+            if (!parseUnary()) return false;
+            emit(ProcessFilter::Op::AND);
+        }
+        return true;
+    }
+
+    bool parseUnary() {
+        if ((token.kind == Kind::NOT || token.kind == Kind::LPAREN) && ++nesting > MAX_NESTING) {
+            return fail("expression is nested too deeply");
+        }
+        if (token.kind == Kind::NOT) {
+            next();
+            if (!parseUnary()) return false;
+            emit(ProcessFilter::Op::NOT);
+            --nesting;
+            return true;
+        }
+        if (token.kind == Kind::LPAREN) {
+            next();
+            if (!parseOr()) return false;
+            if (token.kind != Kind::RPAREN) return fail("expected ')'");
+            next();
+            --nesting;
+            return true;
+        }
+        if (token.kind != Kind::WORD) {
+            return fail(token.kind == Kind::END ? "unexpected end of filter" : "expected a field name");
+        }
+        return parsePredicate();
+    }
+
+    bool parsePredicate() {
+        std::string_view field = token.text;
+        size_t field_column = token.column;
+        next();
+
+        if (field == "kernel") {
+            emitKernel();
+            return true;
+        }
+
+        Kind op = token.kind;
+        size_t op_column = token.column;
+        bool negate = op == Kind::NE || op == Kind::NOMATCH;
+        bool is_set = token.kind == Kind::WORD && token.text == "in";
+        if (!is_set && op != Kind::EQ && op != Kind::NE && op != Kind::LT && op != Kind::LE && op != Kind::GT &&
+            op != Kind::GE && op != Kind::MATCH && op != Kind::NOMATCH) {
+            return fail("expected an operator after '" + std::string(field) + "'");
+        }
+        next();
+        operator_column = op_column;
+
+        bool ok;
+        if (field == "name") {
+            ok = parseNamePredicate(op, is_set);
+        } else if (field == "state") {
+            ok = parseStatePredicate(op, is_set);
+        } else if (field == "user" || field == "group") {
+            ok = parseOwnerPredicate(field == "user" ? Field::UID : Field::GID, op, is_set, true);
+        } else if (field == "uid" || field == "gid") {
+            ok = parseOwnerPredicate(field == "uid" ? Field::UID : Field::GID, op, is_set, false);
+        } else if (field == "pid" || field == "ppid" || field == "rss" || field == "cpu") {
+            Field target = field == "pid" ? Field::PID : field == "ppid" ? Field::PPID
+                         : field == "rss" ? Field::RSS : Field::CPU;
+            ok = parseNumericPredicate(target, op, is_set);
+        } else {
+            return fail("unknown field '" + std::string(field) + "'", field_column);
+        }
+        if (ok && negate) emit(ProcessFilter::Op::NOT);
+        return ok;
+    }
+
+    // Список значений "(a, b, c)"; слова, строки и числа
+    bool parseList(std::vector<std::string>& values) {
+        if (token.kind != Kind::LPAREN) return fail("expected '(' after 'in'");
+        next();
+        value_columns.clear();
+        while (true) {
+            if (token.kind != Kind::WORD && token.kind != Kind::STRING) return fail("expected a value");
+            values.emplace_back(token.text);
+            value_columns.push_back(token.column);
+            next();
+            if (token.kind == Kind::RPAREN) break;
+            if (token.kind != Kind::COMMA) return fail("expected ',' or ')'");
+            next();
+        }
+        next();
+        return true;
+    }
+
+    bool parseValue(std::string& value) {
+        if (token.kind != Kind::WORD && token.kind != Kind::STRING) return fail("expected a value");
+        value.assign(token.text);
+        value_columns.assign(1, token.column);
+        next();
+        return true;
+    }
+
+    bool parseNamePredicate(Kind op, bool is_set) {
+        using MatcherKind = ProcessFilter::NameMatcher::Kind;
+        ProcessFilter::NameMatcher matcher;
+
+        if (is_set || op == Kind::EQ || op == Kind::NE) {
+            if (is_set ? !parseList(matcher.literals) : !parseValue(matcher.literals.emplace_back())) return false;
+            matcher.kind = MatcherKind::EXACT;
+            std::sort(matcher.literals.begin(), matcher.literals.end());
+        } else if (op == Kind::MATCH || op == Kind::NOMATCH) {
+            if (token.kind == Kind::LPAREN) {
+                std::vector<std::string> patterns;
+                if (!parseList(patterns)) return false;
+                matcher.kind = MatcherKind::CONTAINS;
+                matcher.substrings.build(patterns);
+            } else if (token.kind == Kind::REGEX) {
+                if (!compileRegex(token.text, matcher)) return false;
+                next();
+            } else if (token.kind == Kind::STRING || token.kind == Kind::WORD) {
+                matcher.kind = MatcherKind::CONTAINS;
+                matcher.substrings.build({std::string(token.text)});
+                next();
+            } else {
+                return fail("expected /regex/, a string or a list after '~'");
+            }
+        } else {
+            return fail("names support ==, !=, in, ~ and !~", operator_column);
+        }
+
+        emitName(std::move(matcher));
+        return true;
+    }
+
+    // Шаблоны вида lit, ^lit, lit$ и ^lit$ обходятся без std::regex
+    bool compileRegex(std::string_view pattern, ProcessFilter::NameMatcher& matcher) {
+        using MatcherKind = ProcessFilter::NameMatcher::Kind;
+        std::string_view body = pattern;
+        bool anchored_start = !body.empty() && body.front() == '^';
+        if (anchored_start) body.remove_prefix(1);
+        bool anchored_end = !body.empty() && body.back() == '$' && (body.size() < 2 || body[body.size() - 2] != '\\');
+        if (anchored_end) body.remove_suffix(1);
+
+        std::string literal;
+        bool plain = true;
+        for (size_t i = 0; i < body.size() && plain; ++i) {
+            char c = body[i];
+            if (c == '\\' && i + 1 < body.size() && std::ispunct(static_cast<unsigned char>(body[i + 1]))) {
+                literal.push_back(body[++i]);
+            } else if (std::strchr(".[]()*+?{}|\\^$", c)) {
+                plain = false;
+            } else {
+                literal.push_back(c);
+            }
+        }
+
+        if (plain) {
+            matcher.literals.assign(1, literal);
+            if (anchored_start && anchored_end) matcher.kind = MatcherKind::EXACT;
+            else if (anchored_start) matcher.kind = MatcherKind::PREFIX;
+            else if (anchored_end) matcher.kind = MatcherKind::SUFFIX;
+            else {
+                matcher.kind = MatcherKind::CONTAINS;
+                matcher.substrings.build(matcher.literals);
+            }
+            return true;
+        }
+
+        // \/ нужен только для записи внутри /.../
+        std::string source;
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            if (pattern[i] == '\\' && i + 1 < pattern.size() && pattern[i + 1] == '/') continue;
+            source.push_back(pattern[i]);
+        }
+        try {
+            matcher.regex = std::regex(source, std::regex::ECMAScript | std::regex::optimize | std::regex::nosubs);
+        } catch (const std::regex_error&) {
+            return fail("invalid regular expression");
+        }
+        matcher.kind = MatcherKind::REGEX;
+        return true;
+    }
+
+    bool parseStatePredicate(Kind op, bool is_set) {
+        std::vector<std::string> values;
+        if (is_set) {
+            if (!parseList(values)) return false;
+        } else if (op == Kind::EQ || op == Kind::NE) {
+            if (!parseValue(values.emplace_back())) return false;
+        } else {
+            return fail("state supports ==, != and in", operator_column);
+        }
+
+        uint64_t states[2] = {0, 0};
+        for (size_t i = 0; i < values.size(); ++i) {
+            const auto& value = values[i];
+            if (value.size() != 1 || static_cast<unsigned char>(value[0]) >= 128) {
+                return fail("states are single letters such as R, S or D", value_columns[i]);
+            }
+            unsigned char c = static_cast<unsigned char>(value[0]);
+            states[c / 64] |= uint64_t(1) << (c % 64);
+        }
+        uint32_t index = emitPredicate(Field::STATE, Test::IN_STATES, 0.0);
+        filter.predicates[index].states[0] = states[0];
+        filter.predicates[index].states[1] = states[1];
+        return true;
+    }
+
+    bool parseOwnerPredicate(Field target, Kind op, bool is_set, bool by_name) {
+        std::vector<std::string> values;
+        if (is_set) {
+            if (!parseList(values)) return false;
+        } else if (op == Kind::EQ || op == Kind::NE) {
+            if (!parseValue(values.emplace_back())) return false;
+        } else if (!by_name) {
+            return parseNumericPredicate(target, op, false);
+        } else {
+            return fail("users and groups support ==, != and in", operator_column);
+        }
+
+        // Имена переводятся в id один раз, при компиляции
+        ProcessFilter::IdSet ids;
+        for (size_t i = 0; i < values.size(); ++i) {
+            const auto& value = values[i];
+            uint32_t id;
+            bool found = target == Field::UID ? lookupUser(identities, value, id) : lookupGroup(identities, value, id);
+            if (!found) {
+                return fail(std::string(target == Field::UID ? "unknown user '" : "unknown group '") + value + "'",
+                            value_columns[i]);
+            }
+            ids.add(id);
+        }
+        emitIdSet(target, std::move(ids));
+        return true;
+    }
+
+    bool parseNumericPredicate(Field target, Kind op, bool is_set) {
+        if (is_set) {
+            if (target == Field::RSS || target == Field::CPU) {
+                return fail("'in' needs a field with whole numbers", operator_column);
+            }
+            std::vector<std::string> values;
+            if (!parseList(values)) return false;
+            ProcessFilter::IdSet ids;
+            for (size_t i = 0; i < values.size(); ++i) {
+                int64_t number;
+                if (!parseInteger(values[i], number)) return fail("expected a number in the list", value_columns[i]);
+                ids.add(number);
+            }
+            emitIdSet(target, std::move(ids));
+            return true;
+        }
+
+        if (token.kind != Kind::WORD) return fail("expected a number");
+        double number;
+        std::string_view rest;
+        bool valid = target == Field::RSS ? parseSize(token.text, number)
+                                          : parseDecimal(token.text, number, rest) &&
+                                                (rest.empty() || (target == Field::CPU && rest == "%"));
+        if (!valid) {
+            return fail(target == Field::RSS ? "expected a size such as 512M or 1.5G" : "expected a number");
+        }
+        next();
+
+        Test test = Test::EQ;
+        switch (op) {
+            case Kind::LT: test = Test::LT; break;
+            case Kind::LE: test = Test::LE; break;
+            case Kind::GT: test = Test::GT; break;
+            case Kind::GE: test = Test::GE; break;
+            case Kind::EQ:
+            case Kind::NE: test = Test::EQ; break;
+            default: return fail("numbers support ==, !=, <, <=, >, >= and in", operator_column);
+        }
+        emitPredicate(target, test, number);
+        return true;
+    }
+
+    uint32_t emitPredicate(Field field, Test test, double number) {
+        ProcessFilter::Predicate predicate{};
+        predicate.field = field;
+        predicate.test = test;
+        predicate.number = number;
+        switch (field) {
+            case Field::PID: predicate.stage = FilterStage::PID; break;
+            case Field::UID:
+            case Field::GID: predicate.stage = FilterStage::OWNER; break;
+            default: predicate.stage = FilterStage::STAT; break;
+        }
+        uint32_t index = static_cast<uint32_t>(filter.predicates.size());
+        filter.predicates.push_back(predicate);
+        filter.stages_used |= 1u << static_cast<unsigned>(predicate.stage);
+        emit(ProcessFilter::Op::TEST, index);
+        return index;
+    }
+
+    void emitIdSet(Field field, ProcessFilter::IdSet ids) {
+        uint32_t index = emitPredicate(field, Test::IN_IDS, 0.0);
+        filter.predicates[index].index = static_cast<uint32_t>(filter.id_sets.size());
+        filter.id_sets.push_back(std::move(ids));
+    }
+
+    void emitName(ProcessFilter::NameMatcher matcher) {
+        uint32_t index = emitPredicate(Field::NAME, Test::NAME, 0.0);
+        filter.predicates[index].index = static_cast<uint32_t>(filter.matchers.size());
+        filter.matchers.push_back(std::move(matcher));
+    }
+};
+
+ProcessFilter::ProcessFilter() : stack_depth(0), stages_used(0) {
+}
+
+ProcessFilter::~ProcessFilter() = default;
+ProcessFilter::ProcessFilter(ProcessFilter&&) noexcept = default;
+ProcessFilter& ProcessFilter::operator=(ProcessFilter&&) noexcept = default;
+
+bool ProcessFilter::compile(const MtopConfig& config, IdentityCache& identities, std::string& error) {
+    ProcessFilter compiled;
+    FilterCompiler compiler(compiled, identities, config.filter);
+
+    // Части соединяются через AND; дешёвые старые настройки идут первыми
+    size_t parts = 0;
+    auto join = [&]() {
+        if (++parts > 1) compiler.emit(Op::AND);
+    };
+    if (!config.show_kernel_threads) {
+        compiler.emitKernel();
+        compiler.emit(Op::NOT);
+        join();
+    }
+    if (!config.hide_processes.empty()) {
+        compiler.emitHiddenNames(config.hide_processes);
+        join();
+    }
+    if (!config.show_only_users.empty()) {
+        compiler.emitUsers(config.show_only_users);
+        join();
+    }
+    if (config.filter.find_first_not_of(" \t") != std::string::npos) {
+        if (!compiler.compileExpression(error)) return false;
+        join();
+    }
+
+    // Глубина стека вычисления
+    size_t depth = 0;
+    for (const auto& instruction : compiled.program) {
+        if (instruction.op == Op::TEST) {
+            compiled.stack_depth = std::max(compiled.stack_depth, ++depth);
+        } else if (instruction.op != Op::NOT) {
+            --depth;
+        }
+    }
+    if (compiled.stack_depth > MAX_STACK) {
+        error = "filter: expression is nested too deeply";
+        return false;
+    }
+
+    *this = std::move(compiled);
+    return true;
+}
+
+bool ProcessFilter::validate(const std::string& expression, std::string& error) {
+    MtopConfig config;
+    config.show_kernel_threads = true;
+    config.filter = expression;
+    IdentityCache identities;
+    ProcessFilter filter;
+    return filter.compile(config, identities, error);
+}
+
+ProcessFilter::Result ProcessFilter::evaluate(const Row& row, FilterStage available) const {
+    if (program.empty()) return ACCEPT;
+
+    // Трёхзначная логика: UNDECIDED - предикат ждёт данных следующей стадии
+    uint8_t stack[MAX_STACK];
+    size_t top = 0;
+    for (const auto& instruction : program) {
+        switch (instruction.op) {
+            case Op::TEST: {
+                const Predicate& predicate = predicates[instruction.predicate];
+                stack[top++] = predicate.stage > available ? UNDECIDED : test(predicate, row) ? ACCEPT : REJECT;
+                break;
+            }
+            case Op::NOT:
+                if (stack[top - 1] != UNDECIDED) stack[top - 1] ^= 1;
+                break;
+            case Op::AND: {
+                uint8_t b = stack[--top];
+                uint8_t a = stack[top - 1];
+                stack[top - 1] = (a == REJECT || b == REJECT) ? REJECT : (a == ACCEPT && b == ACCEPT) ? ACCEPT : UNDECIDED;
+                break;
+            }
+            case Op::OR: {
+                uint8_t b = stack[--top];
+                uint8_t a = stack[top - 1];
+                stack[top - 1] = (a == ACCEPT || b == ACCEPT) ? ACCEPT : (a == REJECT && b == REJECT) ? REJECT : UNDECIDED;
+                break;
+            }
+        }
+    }
+    return static_cast<Result>(stack[0]);
+}
+
+bool ProcessFilter::uses(FilterStage stage) const {
+    return (stages_used >> static_cast<unsigned>(stage)) & 1;
+}
+
+bool ProcessFilter::test(const Predicate& predicate, const Row& row) const {
+    using Field = Predicate::Field;
+    using Test = Predicate::Test;
+
+    double value = 0.0;
+    switch (predicate.field) {
+        case Field::PID: value = row.pid; break;
+        case Field::PPID: value = row.ppid; break;
+        case Field::UID: value = row.uid; break;
+        case Field::GID: value = row.gid; break;
+        case Field::RSS: value = static_cast<double>(row.rss_kb) * 1024.0; break;
+        case Field::CPU: value = row.cpu_percent; break;
+        case Field::KERNEL: value = row.kernel_thread ? 1.0 : 0.0; break;
+        case Field::STATE: {
+            unsigned char c = static_cast<unsigned char>(row.state);
+            return c < 128 && (predicate.states[c / 64] >> (c % 64) & 1);
+        }
+        case Field::NAME:
+            return matchers[predicate.index].matches(row.name);
+    }
+
+    switch (predicate.test) {
+        case Test::EQ: return value == predicate.number;
+        case Test::LT: return value < predicate.number;
+        case Test::LE: return value <= predicate.number;
+        case Test::GT: return value > predicate.number;
+        case Test::GE: return value >= predicate.number;
+        case Test::IN_IDS: return id_sets[predicate.index].contains(static_cast<int64_t>(value));
+        default: return false;
+    }
+}
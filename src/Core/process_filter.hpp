@@ -0,0 +1,102 @@
+#ifndef PROCESS_FILTER_HPP
+#define PROCESS_FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "substring_matcher.hpp"
+#include "parser.hpp"
+
+class IdentityCache;
+
+// Where the data a predicate looks at comes from, cheapest first
+enum class FilterStage : uint8_t {
+    PID,   // known from the directory listing, before anything is read
+    STAT,  // /proc/PID/stat: ppid, state, name, rss, cpu, kernel thread flag
+    OWNER, // fstat() of the process: uid, gid, user, group
+};
+
+// Process filter compiled from the `filter` expression plus the older
+// hide_processes, show_only_users and show_kernel_threads settings.
+//
+//   expr  := term ( ("||" | "or") term )*
+//   term  := unary ( ("&&" | "and") unary )*
+//   unary := ("!" | "not") unary | "(" expr ")" | "kernel" | field op value
+//
+// Fields: pid, ppid, uid, gid, rss (bytes, K/M/G/T suffixes), cpu (percent),
+// state, name, user, group. Operators: == != < <= > >= for numbers,
+// == != for text, "in (a, b, ...)" for sets, "~ /regex/" and
+// "~ (a, b, ...)" (contains any) for names; "!~" negates a match.
+//
+// The expression becomes a postfix program evaluated in three-valued
+// logic, so the collector can ask after each stage whether a process is
+// already decided and skip reading costlier sources when it is. Users and
+// groups are resolved to ids once; id sets are bitsets, substring sets one
+// Aho-Corasick automaton, and regexes that are plain literals, prefixes or
+// suffixes never reach std::regex.
+class ProcessFilter {
+public:
+    enum Result : uint8_t { REJECT = 0, ACCEPT = 1, UNDECIDED = 2 };
+
+    // What the predicates can look at; fields of later stages may be unset
+    struct Row {
+        int pid = 0;
+        int ppid = 0;
+        char state = '?';
+        std::string_view name;
+        uint64_t rss_kb = 0;
+        double cpu_percent = 0.0;
+        bool kernel_thread = false;
+        int uid = -1;
+        int gid = -1;
+    };
+
+    ProcessFilter();
+    ~ProcessFilter();
+
+    ProcessFilter(ProcessFilter&&) noexcept;
+    ProcessFilter& operator=(ProcessFilter&&) noexcept;
+
+    // Compile the filter for a configuration. User and group names are
+    // resolved through `identities`, so the filter must be recompiled when
+    // its refresh() reports a change. On a syntax error the message (with
+    // the column) goes to error and the filter is unchanged.
+    bool compile(const MtopConfig& config, IdentityCache& identities, std::string& error);
+
+    // Check an expression without keeping it
+    static bool validate(const std::string& expression, std::string& error);
+
+    // Decide a row using predicates up to and including `available`
+    Result evaluate(const Row& row, FilterStage available) const;
+
+    // True if some predicate needs data from the given stage
+    bool uses(FilterStage stage) const;
+
+    struct Predicate;
+    struct IdSet;
+    struct NameMatcher;
+
+private:
+    enum class Op : uint8_t { TEST, NOT, AND, OR };
+    struct Instruction {
+        Op op;
+        uint32_t predicate;
+    };
+
+    std::vector<Instruction> program;
+    std::vector<Predicate> predicates;
+    std::vector<IdSet> id_sets;
+    std::vector<NameMatcher> matchers;
+    size_t stack_depth;
+    uint32_t stages_used;
+
+    friend class FilterCompiler;
+
+    bool test(const Predicate& predicate, const Row& row) const;
+};
+
+#endif // PROCESS_FILTER_HPP
@@ -0,0 +1,50 @@
+#include "process_table.hpp"
+
+size_t ProcessTable::appendRow() {
+    size_t row = pid.size();
+
+    pid.push_back(0);
+    ppid.push_back(0);
+    uid.push_back(-1);
+    gid.push_back(-1);
+    name_id.push_back(0);
+    state.push_back('?');
+    kernel_thread.push_back(0);
+    utime.push_back(0);
+    stime.push_back(0);
+    start_time.push_back(0);
+    rss_kb.push_back(0);
+    cpu_percent.push_back(0.0);
+
+    return row;
+}
+
+void ProcessTable::clear() {
+    pid.clear();
+    ppid.clear();
+    uid.clear();
+    gid.clear();
+    name_id.clear();
+    state.clear();
+    kernel_thread.clear();
+    utime.clear();
+    stime.clear();
+    start_time.clear();
+    rss_kb.clear();
+    cpu_percent.clear();
+}
+
+void ProcessTable::reserve(size_t rows) {
+    pid.reserve(rows);
+    ppid.reserve(rows);
+    uid.reserve(rows);
+    gid.reserve(rows);
+    name_id.reserve(rows);
+    state.reserve(rows);
+    kernel_thread.reserve(rows);
+    utime.reserve(rows);
+    stime.reserve(rows);
+    start_time.reserve(rows);
+    rss_kb.reserve(rows);
+    cpu_percent.reserve(rows);
+}
@@ -0,0 +1,41 @@
+#ifndef PROCESS_TABLE_HPP
+#define PROCESS_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Column-oriented storage for one scan of the process list.
+// Every column has size() entries; row i describes the same process in all
+// of them. Names are ids in the owner's StringInterner and users are kept
+// as uid/gid, so the table holds no strings. clear() keeps the capacity,
+// which lets two tables be swapped between ticks without reallocating.
+//
+// name_id, uid, gid and kernel_thread are static for the life of a
+// process and are carried over from the previous tick's row; uid and gid
+// stay -1 until something needs the owner.
+class ProcessTable {
+public:
+    std::vector<int> pid;
+    std::vector<int> ppid;
+    std::vector<int> uid;
+    std::vector<int> gid;
+    std::vector<uint32_t> name_id;
+    std::vector<char> state;
+    std::vector<uint8_t> kernel_thread;
+    std::vector<uint64_t> utime;
+    std::vector<uint64_t> stime;
+    std::vector<uint64_t> start_time;
+    std::vector<uint64_t> rss_kb;
+    std::vector<double> cpu_percent;
+
+    size_t size() const { return pid.size(); }
+
+    // Append a row with every column default-initialized and return its index
+    size_t appendRow();
+
+    void clear();
+    void reserve(size_t rows);
+};
+
+#endif // PROCESS_TABLE_HPP
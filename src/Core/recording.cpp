@@ -0,0 +1,643 @@
+#include "recording.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[8] = {'M', 'T', 'O', 'P', 'R', 'E', 'C', '\0'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 16;
+
+constexpr uint8_t RECORD_STRING = 'S';
+constexpr uint8_t RECORD_KEYFRAME = 'K';
+constexpr uint8_t RECORD_DELTA = 'D';
+
+// Какие системные поля есть в дельте
+constexpr uint64_t SYS_CPU = 1u << 0;
+constexpr uint64_t SYS_CORES = 1u << 1;
+constexpr uint64_t SYS_MEMORY = 1u << 2;
+constexpr uint64_t SYS_LOAD = 1u << 3;
+constexpr uint64_t SYS_COUNT = 1u << 4;
+constexpr uint64_t SYS_NETWORK = 1u << 5;
+
+// Какие поля строки процесса записаны
+constexpr uint8_t ROW_IDENTITY = 1u << 0;
+constexpr uint8_t ROW_STATE = 1u << 1;
+constexpr uint8_t ROW_CPU = 1u << 2;
+constexpr uint8_t ROW_MEMORY = 1u << 3;
+constexpr uint8_t ROW_ALL = ROW_IDENTITY | ROW_STATE | ROW_CPU | ROW_MEMORY;
+
+void putVarint(FrameBuffer& out, uint64_t value) {
+    char bytes[10];
+    size_t n = 0;
+    while (value >= 0x80) {
+        bytes[n++] = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    bytes[n++] = static_cast<char>(value);
+    out.append(bytes, n);
+}
+
+void putZigzag(FrameBuffer& out, int64_t value) {
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void putU32(FrameBuffer& out, uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    out.append(bytes, 4);
+}
+
+inline int64_t difference(uint64_t value, uint64_t base) {
+    return static_cast<int64_t>(value - base);
+}
+
+// Последовательное чтение полезной нагрузки; ошибка формата запоминается в ok
+struct ByteReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok;
+
+    ByteReader(const uint8_t* data, size_t length) : p(data), end(data + length), ok(true) {}
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) break;
+            uint8_t byte = *p++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64_t zigzag() {
+        uint64_t value = varint();
+        return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+    }
+
+    uint8_t byte() {
+        if (p >= end) {
+            ok = false;
+            return 0;
+        }
+        return *p++;
+    }
+};
+
+inline uint32_t tenths(double value) {
+    return value > 0.0 ? static_cast<uint32_t>(value * 10.0 + 0.5) : 0;
+}
+
+inline uint32_t hundredths(double value) {
+    return value > 0.0 ? static_cast<uint32_t>(value * 100.0 + 0.5) : 0;
+}
+
+// Вызывает handler(type, payload, length, offset) для каждой целой записи.
+// Возвращает конец последней целой записи или 0, если заголовок не наш.
+template <typename Handler>
+size_t scanRecords(const uint8_t* data, size_t size, Handler&& handler) {
+    if (size < HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) return 0;
+
+    uint32_t version = 0;
+    for (int i = 0; i < 4; ++i) version |= static_cast<uint32_t>(data[8 + i]) << (8 * i);
+    if (version == 0 || version > VERSION) return 0;
+
+    size_t offset = HEADER_SIZE;
+    while (offset < size) {
+        ByteReader reader(data + offset + 1, size - offset - 1);
+        uint64_t length = reader.varint();
+        if (!reader.ok) break;
+
+        size_t start = static_cast<size_t>(reader.p - data);
+        if (length > size - start) break; // запись оборвана на середине
+
+        handler(data[offset], data + start, static_cast<size_t>(length), offset);
+        offset = start + static_cast<size_t>(length);
+    }
+    return offset;
+}
+
+} // namespace
+
+Recorder::Recorder() : fd(-1), next_string_id(0), have_previous(false), since_keyframe(0), payload(4096), output(8192) {
+}
+
+Recorder::~Recorder() {
+    if (fd >= 0) ::close(fd);
+}
+
+bool Recorder::open(const std::string& path) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) return false;
+
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        output.clear();
+        output.append(MAGIC, sizeof(MAGIC));
+        putU32(output, VERSION);
+        putU32(output, 0);
+        return output.writeTo(fd);
+    }
+
+    // Продолжаем существующую запись: нужна её таблица строк
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) return false;
+
+    size_t valid_end = scanRecords(static_cast<const uint8_t*>(mapped), size,
+        [this](uint8_t type, const uint8_t* data, size_t length, size_t) {
+            if (type == RECORD_STRING) {
+                string_ids.emplace(std::string(reinterpret_cast<const char*>(data), length), next_string_id++);
+            }
+        });
+    munmap(mapped, size);
+
+    if (valid_end == 0) {
+        errno = EINVAL;
+        return false;
+    }
+
+    // Оборванную последнюю запись (например, после сбоя питания) отрезаем
+    if (valid_end < size && ftruncate(fd, static_cast<off_t>(valid_end)) != 0) return false;
+    return lseek(fd, 0, SEEK_END) >= 0;
+}
+
+bool Recorder::append(const Snapshot& snapshot) {
+    output.clear();
+    capture(snapshot);
+
+    payload.clear();
+    if (!have_previous || since_keyframe >= KEYFRAME_INTERVAL) {
+        encodeKeyframe();
+        emitRecord(RECORD_KEYFRAME);
+        since_keyframe = 1;
+    } else {
+        encodeDelta();
+        emitRecord(RECORD_DELTA);
+        ++since_keyframe;
+    }
+
+    if (!output.writeTo(fd)) {
+        // Следующая выборка начнётся с ключевого кадра
+        have_previous = false;
+        return false;
+    }
+
+    std::swap(previous, current);
+    have_previous = true;
+
+    previous_rows.clear();
+    for (size_t i = 0; i < previous.processes.size(); ++i) {
+        previous_rows[previous.processes[i].pid] = i;
+    }
+    return true;
+}
+
+uint32_t Recorder::intern(const std::string& text) {
+    auto it = string_ids.find(text);
+    if (it != string_ids.end()) return it->second;
+
+    // Новая строка попадает в файл раньше выборки, которая на неё ссылается
+    uint32_t id = next_string_id++;
+    string_ids.emplace(text, id);
+    output.append(static_cast<char>(RECORD_STRING));
+    putVarint(output, text.size());
+    output.append(text);
+    return id;
+}
+
+void Recorder::capture(const Snapshot& snapshot) {
+    const SystemStats& stats = snapshot.stats;
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    current.time_ms = static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+
+    current.cpu = tenths(stats.cpu_percent);
+    current.cores.resize(stats.cpu_cores.size());
+    for (size_t i = 0; i < stats.cpu_cores.size(); ++i) {
+        current.cores[i] = tenths(stats.cpu_cores[i].total);
+    }
+
+    current.total_memory_kb = stats.total_memory_kb;
+    current.used_memory_kb = stats.used_memory_kb;
+    current.free_memory_kb = stats.free_memory_kb;
+    for (int i = 0; i < 3; ++i) current.load[i] = hundredths(stats.load_avg[i]);
+    current.process_count = static_cast<uint32_t>(std::max(0, stats.process_count));
+
+    current.interfaces.resize(stats.network_interfaces.size());
+    for (size_t i = 0; i < stats.network_interfaces.size(); ++i) {
+        const auto& net = stats.network_interfaces[i];
+        RecordedInterface& recorded = current.interfaces[i];
+        recorded.name = intern(net.interface);
+        recorded.rx_bytes = net.rx_bytes;
+        recorded.tx_bytes = net.tx_bytes;
+        recorded.rx_packets = net.rx_packets;
+        recorded.tx_packets = net.tx_packets;
+    }
+
+    current.processes.resize(stats.processes.size());
+    for (size_t i = 0; i < stats.processes.size(); ++i) {
+        const auto& proc = stats.processes[i];
+        RecordedProcess& recorded = current.processes[i];
+        recorded.pid = proc.pid;
+        recorded.name = intern(proc.name);
+        recorded.user = intern(proc.user);
+        recorded.group = intern(proc.group);
+        recorded.uid = proc.uid;
+        recorded.gid = proc.gid;
+        recorded.state = proc.state.empty() ? '?' : proc.state[0];
+        recorded.is_kernel_thread = proc.is_kernel_thread;
+        recorded.cpu = tenths(proc.cpu_percent);
+        recorded.memory_kb = proc.memory_kb;
+    }
+}
+
+void Recorder::encodeKeyframe() {
+    putVarint(payload, static_cast<uint64_t>(current.time_ms));
+    putVarint(payload, current.cpu);
+    putVarint(payload, current.cores.size());
+    for (uint32_t core : current.cores) putVarint(payload, core);
+    putVarint(payload, current.total_memory_kb);
+    putVarint(payload, current.used_memory_kb);
+    putVarint(payload, current.free_memory_kb);
+    for (uint32_t load : current.load) putVarint(payload, load);
+    putVarint(payload, current.process_count);
+
+    putVarint(payload, current.interfaces.size());
+    for (const auto& net : current.interfaces) {
+        putVarint(payload, net.name);
+        putVarint(payload, net.rx_bytes);
+        putVarint(payload, net.tx_bytes);
+        putVarint(payload, net.rx_packets);
+        putVarint(payload, net.tx_packets);
+    }
+
+    encodeProcesses(true);
+}
+
+void Recorder::encodeDelta() {
+    putZigzag(payload, current.time_ms - previous.time_ms);
+
+    uint64_t mask = 0;
+    if (current.cpu != previous.cpu) mask |= SYS_CPU;
+    if (current.cores != previous.cores) mask |= SYS_CORES;
+    if (current.total_memory_kb != previous.total_memory_kb || current.used_memory_kb != previous.used_memory_kb ||
+        current.free_memory_kb != previous.free_memory_kb) {
+        mask |= SYS_MEMORY;
+    }
+    if (!std::equal(current.load, current.load + 3, previous.load)) mask |= SYS_LOAD;
+    if (current.process_count != previous.process_count) mask |= SYS_COUNT;
+
+    bool network_changed = current.interfaces.size() != previous.interfaces.size();
+    for (size_t i = 0; !network_changed && i < current.interfaces.size(); ++i) {
+        const auto& a = current.interfaces[i];
+        const auto& b = previous.interfaces[i];
+        network_changed = a.name != b.name || a.rx_bytes != b.rx_bytes || a.tx_bytes != b.tx_bytes ||
+                          a.rx_packets != b.rx_packets || a.tx_packets != b.tx_packets;
+    }
+    if (network_changed) mask |= SYS_NETWORK;
+
+    putVarint(payload, mask);
+    if (mask & SYS_CPU) putVarint(payload, current.cpu);
+    if (mask & SYS_CORES) {
+        putVarint(payload, current.cores.size());
+        for (uint32_t core : current.cores) putVarint(payload, core);
+    }
+    if (mask & SYS_MEMORY) {
+        putZigzag(payload, difference(current.total_memory_kb, previous.total_memory_kb));
+        putZigzag(payload, difference(current.used_memory_kb, previous.used_memory_kb));
+        putZigzag(payload, difference(current.free_memory_kb, previous.free_memory_kb));
+    }
+    if (mask & SYS_LOAD) {
+        for (uint32_t load : current.load) putVarint(payload, load);
+    }
+    if (mask & SYS_COUNT) putVarint(payload, current.process_count);
+    if (mask & SYS_NETWORK) {
+        // Счётчики интерфейса пишем разностью с тем же интерфейсом на той же позиции
+        putVarint(payload, current.interfaces.size());
+        for (size_t i = 0; i < current.interfaces.size(); ++i) {
+            const auto& net = current.interfaces[i];
+            RecordedInterface base = {net.name, 0, 0, 0, 0};
+            if (i < previous.interfaces.size() && previous.interfaces[i].name == net.name) {
+                base = previous.interfaces[i];
+            }
+            putVarint(payload, net.name);
+            putZigzag(payload, difference(net.rx_bytes, base.rx_bytes));
+            putZigzag(payload, difference(net.tx_bytes, base.tx_bytes));
+            putZigzag(payload, difference(net.rx_packets, base.rx_packets));
+            putZigzag(payload, difference(net.tx_packets, base.tx_packets));
+        }
+    }
+
+    encodeProcesses(false);
+}
+
+void Recorder::encodeProcesses(bool keyframe) {
+    putVarint(payload, current.processes.size());
+    for (const auto& proc : current.processes) {
+        const RecordedProcess* prev = nullptr;
+        if (!keyframe) {
+            auto it = previous_rows.find(proc.pid);
+            if (it != previous_rows.end()) prev = &previous.processes[it->second];
+        }
+
+        // Для известного PID пишем только изменившиеся поля
+        uint8_t mask = ROW_ALL;
+        if (prev) {
+            mask = 0;
+            if (proc.name != prev->name || proc.user != prev->user || proc.group != prev->group ||
+                proc.uid != prev->uid || proc.gid != prev->gid || proc.is_kernel_thread != prev->is_kernel_thread) {
+                mask |= ROW_IDENTITY;
+            }
+            if (proc.state != prev->state) mask |= ROW_STATE;
+            if (proc.cpu != prev->cpu) mask |= ROW_CPU;
+            if (proc.memory_kb != prev->memory_kb) mask |= ROW_MEMORY;
+        }
+
+        putVarint(payload, static_cast<uint64_t>(proc.pid));
+        payload.append(static_cast<char>(mask));
+        if (mask & ROW_IDENTITY) {
+            putVarint(payload, proc.name);
+            putVarint(payload, proc.user);
+            putVarint(payload, proc.group);
+            putZigzag(payload, proc.uid);
+            putZigzag(payload, proc.gid);
+            payload.append(static_cast<char>(proc.is_kernel_thread ? 1 : 0));
+        }
+        if (mask & ROW_STATE) payload.append(proc.state);
+        if (mask & ROW_CPU) putVarint(payload, proc.cpu);
+        if (mask & ROW_MEMORY) putZigzag(payload, difference(proc.memory_kb, prev ? prev->memory_kb : 0));
+    }
+}
+
+void Recorder::emitRecord(char type) {
+    output.append(type);
+    putVarint(output, payload.size());
+    output.append(payload.data(), payload.size());
+}
+
+Replay::Replay()
+    : data(nullptr), data_size(0), end_offset(0), sample_count(0), state_index(SIZE_MAX), state_offset(0) {
+}
+
+Replay::~Replay() {
+    if (data) munmap(const_cast<uint8_t*>(data), data_size);
+}
+
+bool Replay::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        errno = EINVAL;
+        return false;
+    }
+
+    data_size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        data_size = 0;
+        return false;
+    }
+    data = static_cast<const uint8_t*>(mapped);
+
+    // Один проход: таблица строк и индекс ключевых кадров
+    end_offset = scanRecords(data, data_size, [this](uint8_t type, const uint8_t* payload, size_t length, size_t offset) {
+        if (type == RECORD_STRING) {
+            strings.emplace_back(reinterpret_cast<const char*>(payload), length);
+        } else if (type == RECORD_KEYFRAME) {
+            keyframes.push_back({sample_count, offset});
+            ++sample_count;
+        } else if (type == RECORD_DELTA && !keyframes.empty()) {
+            ++sample_count;
+        }
+    });
+
+    if (end_offset == 0 || sample_count == 0) {
+        errno = EINVAL;
+        return false;
+    }
+    return true;
+}
+
+bool Replay::read(size_t index, SystemStats& stats, int64_t& time_ms) {
+    if (index >= sample_count) return false;
+
+    if (index != state_index) {
+        // Ближайший ключевой кадр не позже нужной выборки
+        auto it = std::upper_bound(keyframes.begin(), keyframes.end(), index,
+                                   [](size_t value, const Keyframe& keyframe) { return value < keyframe.sample; });
+        --it;
+
+        // Вперёд в пределах того же блока продолжаем с текущего места
+        size_t position = state_index;
+        if (state_index == SIZE_MAX || index < state_index || state_index < it->sample) {
+            state_offset = it->offset;
+            position = it->sample;
+            if (!decodeNext()) {
+                state_index = SIZE_MAX;
+                return false;
+            }
+        }
+        while (position < index) {
+            if (!decodeNext()) {
+                state_index = SIZE_MAX;
+                return false;
+            }
+            ++position;
+        }
+        state_index = index;
+    }
+
+    toStats(stats);
+    time_ms = state.time_ms;
+    return true;
+}
+
+bool Replay::decodeNext() {
+    while (state_offset < end_offset) {
+        ByteReader reader(data + state_offset + 1, end_offset - state_offset - 1);
+        uint64_t length = reader.varint();
+        if (!reader.ok) return false;
+
+        uint8_t type = data[state_offset];
+        const uint8_t* payload = reader.p;
+        state_offset = static_cast<size_t>(payload - data) + static_cast<size_t>(length);
+
+        // Строки уже загружены при открытии, неизвестные записи пропускаем
+        if (type == RECORD_KEYFRAME || type == RECORD_DELTA) {
+            return decodeSample(payload, static_cast<size_t>(length), type == RECORD_KEYFRAME);
+        }
+    }
+    return false;
+}
+
+bool Replay::decodeSample(const uint8_t* p, size_t length, bool keyframe) {
+    ByteReader in(p, length);
+    RecordedSample& s = state;
+
+    if (keyframe) {
+        s.time_ms = static_cast<int64_t>(in.varint());
+        s.cpu = static_cast<uint32_t>(in.varint());
+        s.cores.resize(static_cast<size_t>(std::min<uint64_t>(in.varint(), length)));
+        for (auto& core : s.cores) core = static_cast<uint32_t>(in.varint());
+        s.total_memory_kb = in.varint();
+        s.used_memory_kb = in.varint();
+        s.free_memory_kb = in.varint();
+        for (auto& load : s.load) load = static_cast<uint32_t>(in.varint());
+        s.process_count = static_cast<uint32_t>(in.varint());
+
+        s.interfaces.resize(static_cast<size_t>(std::min<uint64_t>(in.varint(), length)));
+        for (auto& net : s.interfaces) {
+            net.name = static_cast<uint32_t>(in.varint());
+            net.rx_bytes = in.varint();
+            net.tx_bytes = in.varint();
+            net.rx_packets = in.varint();
+            net.tx_packets = in.varint();
+        }
+    } else {
+        s.time_ms += in.zigzag();
+        uint64_t mask = in.varint();
+        if (mask & SYS_CPU) s.cpu = static_cast<uint32_t>(in.varint());
+        if (mask & SYS_CORES) {
+            s.cores.resize(static_cast<size_t>(std::min<uint64_t>(in.varint(), length)));
+            for (auto& core : s.cores) core = static_cast<uint32_t>(in.varint());
+        }
+        if (mask & SYS_MEMORY) {
+            s.total_memory_kb += static_cast<uint64_t>(in.zigzag());
+            s.used_memory_kb += static_cast<uint64_t>(in.zigzag());
+            s.free_memory_kb += static_cast<uint64_t>(in.zigzag());
+        }
+        if (mask & SYS_LOAD) {
+            for (auto& load : s.load) load = static_cast<uint32_t>(in.varint());
+        }
+        if (mask & SYS_COUNT) s.process_count = static_cast<uint32_t>(in.varint());
+        if (mask & SYS_NETWORK) {
+            size_t old_count = s.interfaces.size();
+            s.interfaces.resize(static_cast<size_t>(std::min<uint64_t>(in.varint(), length)));
+            for (size_t i = 0; i < s.interfaces.size(); ++i) {
+                RecordedInterface& net = s.interfaces[i];
+                uint32_t name = static_cast<uint32_t>(in.varint());
+                if (i >= old_count || net.name != name) net = {name, 0, 0, 0, 0};
+                net.rx_bytes += static_cast<uint64_t>(in.zigzag());
+                net.tx_bytes += static_cast<uint64_t>(in.zigzag());
+                net.rx_packets += static_cast<uint64_t>(in.zigzag());
+                net.tx_packets += static_cast<uint64_t>(in.zigzag());
+            }
+        }
+    }
+
+    // Строки процессов: новые значения поверх предыдущих для того же PID
+    previous_rows.clear();
+    if (!keyframe) {
+        for (size_t i = 0; i < s.processes.size(); ++i) previous_rows[s.processes[i].pid] = i;
+    }
+
+    size_t count = static_cast<size_t>(std::min<uint64_t>(in.varint(), length));
+    rows.resize(count);
+    for (auto& row : rows) {
+        int pid = static_cast<int>(in.varint());
+        uint8_t mask = in.byte();
+
+        auto it = previous_rows.find(pid);
+        if (it != previous_rows.end()) {
+            row = s.processes[it->second];
+        } else if ((mask & ROW_ALL) != ROW_ALL) {
+            return false; // новый PID обязан нести все поля
+        } else {
+            row = RecordedProcess{};
+        }
+        row.pid = pid;
+
+        if (mask & ROW_IDENTITY) {
+            row.name = static_cast<uint32_t>(in.varint());
+            row.user = static_cast<uint32_t>(in.varint());
+            row.group = static_cast<uint32_t>(in.varint());
+            row.uid = static_cast<int>(in.zigzag());
+            row.gid = static_cast<int>(in.zigzag());
+            row.is_kernel_thread = in.byte() != 0;
+        }
+        if (mask & ROW_STATE) row.state = static_cast<char>(in.byte());
+        if (mask & ROW_CPU) row.cpu = static_cast<uint32_t>(in.varint());
+        if (mask & ROW_MEMORY) row.memory_kb += static_cast<uint64_t>(in.zigzag());
+    }
+    s.processes.swap(rows);
+
+    return in.ok;
+}
+
+void Replay::toStats(SystemStats& stats) const {
+    const RecordedSample& s = state;
+
+    stats.cpu_percent = s.cpu / 10.0;
+    stats.cpu_cores.resize(s.cores.size());
+    for (size_t i = 0; i < s.cores.size(); ++i) {
+        stats.cpu_cores[i] = CpuCoreStats{};
+        stats.cpu_cores[i].cpu = static_cast<int>(i);
+        stats.cpu_cores[i].total = s.cores[i] / 10.0;
+    }
+
+    stats.total_memory_kb = s.total_memory_kb;
+    stats.used_memory_kb = s.used_memory_kb;
+    stats.free_memory_kb = s.free_memory_kb;
+    for (int i = 0; i < 3; ++i) stats.load_avg[i] = s.load[i] / 100.0;
+    stats.process_count = static_cast<int>(s.process_count);
+
+    stats.network_interfaces.resize(s.interfaces.size());
+    for (size_t i = 0; i < s.interfaces.size(); ++i) {
+        const auto& net = s.interfaces[i];
+        NetworkStats& out = stats.network_interfaces[i];
+        out.interface = lookup(net.name);
+        out.rx_bytes = net.rx_bytes;
+        out.tx_bytes = net.tx_bytes;
+        out.rx_packets = net.rx_packets;
+        out.tx_packets = net.tx_packets;
+    }
+
+    stats.processes.resize(s.processes.size());
+    for (size_t i = 0; i < s.processes.size(); ++i) {
+        const auto& proc = s.processes[i];
+        ProcessInfo& out = stats.processes[i];
+        out.pid = proc.pid;
+        out.tgid = proc.pid;
+        out.ppid = 0; // не записывается
+        out.name = lookup(proc.name);
+        out.state.assign(1, proc.state);
+        out.cpu_percent = proc.cpu / 10.0;
+        out.cpu_user_percent = 0.0; // разбивка на user/system не записывается
+        out.cpu_system_percent = 0.0;
+        out.memory_kb = proc.memory_kb;
+        setMemoryDetail(out, nullptr); // smaps_rollup не записывается
+        out.user = lookup(proc.user);
+        out.group = lookup(proc.group);
+        out.uid = proc.uid;
+        out.gid = proc.gid;
+        out.is_kernel_thread = proc.is_kernel_thread;
+        out.utime = 0;
+        out.stime = 0;
+        out.start_time = 0;
+    }
+}
+
+const std::string& Replay::lookup(uint32_t id) const {
+    static const std::string unknown;
+    return id < strings.size() ? strings[id] : unknown;
+}
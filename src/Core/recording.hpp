@@ -0,0 +1,146 @@
+#ifndef RECORDING_HPP
+#define RECORDING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "system_info.hpp"
+#include "frame_buffer.hpp"
+
+// Recording file format (version 1), all integers little-endian:
+//
+//   header:  "MTOPREC\0", u32 version, u32 flags (0)
+//   record:  u8 type, varint payload length, payload
+//
+// Record types:
+//   'S'  string table entry, ids are assigned in file order
+//   'K'  keyframe, a self-contained sample
+//   'D'  delta against the previous sample
+//
+// Numbers are LEB128 varints; values that can go down are zigzag-encoded
+// differences. Percentages are stored in tenths and load averages in
+// hundredths, the precision Display shows. Deltas carry only the fields
+// and per-PID counters that changed. A keyframe starts every recording
+// session and then every KEYFRAME_INTERVAL samples, so a seek decodes at
+// most that many records after a binary search over the keyframe index.
+// Unknown record types are skipped by length.
+
+struct RecordedProcess {
+    int pid;
+    uint32_t name;  // string id
+    uint32_t user;  // string id
+    uint32_t group; // string id
+    int uid;
+    int gid;
+    char state;
+    bool is_kernel_thread;
+    uint32_t cpu; // percent * 10
+    uint64_t memory_kb;
+};
+
+struct RecordedInterface {
+    uint32_t name; // string id
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+    uint64_t rx_packets;
+    uint64_t tx_packets;
+};
+
+struct RecordedSample {
+    int64_t time_ms = 0; // Unix time
+    uint32_t cpu = 0;    // percent * 10
+    std::vector<uint32_t> cores;
+    uint64_t total_memory_kb = 0;
+    uint64_t used_memory_kb = 0;
+    uint64_t free_memory_kb = 0;
+    uint32_t load[3] = {0, 0, 0}; // load average * 100
+    uint32_t process_count = 0;
+    std::vector<RecordedInterface> interfaces;
+    std::vector<RecordedProcess> processes;
+};
+
+// Appends snapshots to a recording file. An existing recording is
+// continued: its string table is loaded and a torn last record is cut off.
+class Recorder {
+public:
+    Recorder();
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // On failure errno describes the problem (EINVAL: not a recording)
+    bool open(const std::string& path);
+
+    // Encode one snapshot and write it with a single write()
+    bool append(const Snapshot& snapshot);
+
+    static constexpr uint64_t KEYFRAME_INTERVAL = 60;
+
+private:
+    int fd;
+    std::unordered_map<std::string, uint32_t> string_ids;
+    uint32_t next_string_id;
+    RecordedSample previous;
+    RecordedSample current;
+    bool have_previous;
+    uint64_t since_keyframe;
+    FrameBuffer payload;
+    FrameBuffer output;
+    std::unordered_map<int, size_t> previous_rows; // pid -> row in previous
+
+    uint32_t intern(const std::string& text);
+    void capture(const Snapshot& snapshot);
+    void encodeKeyframe();
+    void encodeDelta();
+    void encodeProcesses(bool keyframe);
+    void emitRecord(char type);
+};
+
+// Read-only view of a recording through mmap(). open() scans the file
+// once to load the string table and build the keyframe index.
+class Replay {
+public:
+    Replay();
+    ~Replay();
+
+    Replay(const Replay&) = delete;
+    Replay& operator=(const Replay&) = delete;
+
+    bool open(const std::string& path);
+
+    size_t size() const { return sample_count; }
+
+    // Decode sample `index` into stats; time_ms receives its Unix time.
+    // Stepping forward by one continues from the current position,
+    // anything else seeks from the nearest keyframe.
+    bool read(size_t index, SystemStats& stats, int64_t& time_ms);
+
+private:
+    struct Keyframe {
+        size_t sample;
+        size_t offset;
+    };
+
+    const uint8_t* data;
+    size_t data_size;
+    size_t end_offset; // end of the last complete record
+    size_t sample_count;
+    std::vector<std::string> strings;
+    std::vector<Keyframe> keyframes;
+
+    RecordedSample state;
+    size_t state_index;  // sample held in state, or SIZE_MAX
+    size_t state_offset; // offset right after that sample's record
+    std::unordered_map<int, size_t> previous_rows;
+    std::vector<RecordedProcess> rows; // scratch for decoding process rows
+
+    bool decodeNext();
+    bool decodeSample(const uint8_t* p, size_t length, bool keyframe);
+    void toStats(SystemStats& stats) const;
+    const std::string& lookup(uint32_t id) const;
+};
+
+#endif // RECORDING_HPP
@@ -0,0 +1,259 @@
+#include "screen.hpp"
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int DEFAULT_ROWS = 24;
+constexpr int DEFAULT_COLS = 80;
+
+// Биты атрибутов в стиле ячейки
+constexpr uint16_t ATTR_BOLD = 1u << 0;
+constexpr uint16_t ATTR_DIM = 1u << 1;
+constexpr uint16_t ATTR_UNDERLINE = 1u << 2;
+constexpr uint16_t ATTR_REVERSE = 1u << 3;
+
+// Индексы цветов: 0 - по умолчанию, 1..8 - обычные, 9..16 - яркие
+constexpr int FG_SHIFT = 4;
+constexpr int BG_SHIFT = 9;
+constexpr uint16_t COLOR_MASK = 0x1f;
+
+// Если между изменёнными ячейками столько неизменных или меньше,
+// дешевле перепечатать их, чем переставлять курсор
+constexpr int MAX_REWRITE_GAP = 4;
+
+inline uint16_t setColor(uint16_t style, int shift, uint16_t index) {
+    return static_cast<uint16_t>((style & ~(COLOR_MASK << shift)) | (index << shift));
+}
+
+// Применяет один параметр SGR к текущему стилю
+uint16_t applySgr(uint16_t style, int param) {
+    switch (param) {
+        case 0: return 0;
+        case 1: return style | ATTR_BOLD;
+        case 2: return style | ATTR_DIM;
+        case 4: return style | ATTR_UNDERLINE;
+        case 7: return style | ATTR_REVERSE;
+        case 22: return style & ~(ATTR_BOLD | ATTR_DIM);
+        case 24: return style & ~ATTR_UNDERLINE;
+        case 27: return style & ~ATTR_REVERSE;
+        case 39: return setColor(style, FG_SHIFT, 0);
+        case 49: return setColor(style, BG_SHIFT, 0);
+        default: break;
+    }
+    if (param >= 30 && param <= 37) return setColor(style, FG_SHIFT, static_cast<uint16_t>(param - 30 + 1));
+    if (param >= 90 && param <= 97) return setColor(style, FG_SHIFT, static_cast<uint16_t>(param - 90 + 9));
+    if (param >= 40 && param <= 47) return setColor(style, BG_SHIFT, static_cast<uint16_t>(param - 40 + 1));
+    if (param >= 100 && param <= 107) return setColor(style, BG_SHIFT, static_cast<uint16_t>(param - 100 + 9));
+    return style;
+}
+
+void appendColor(FrameBuffer& out, uint16_t index, int normal_base, int bright_base) {
+    if (index == 0) return;
+    out.append(';');
+    out.appendInt(index <= 8 ? normal_base + index - 1 : bright_base + index - 9);
+}
+
+// Полная последовательность SGR от сброшенного состояния
+void appendStyle(FrameBuffer& out, uint16_t style) {
+    out.append("\033[0");
+    if (style & ATTR_BOLD) out.append(";1");
+    if (style & ATTR_DIM) out.append(";2");
+    if (style & ATTR_UNDERLINE) out.append(";4");
+    if (style & ATTR_REVERSE) out.append(";7");
+    appendColor(out, (style >> FG_SHIFT) & COLOR_MASK, 30, 90);
+    appendColor(out, (style >> BG_SHIFT) & COLOR_MASK, 40, 100);
+    out.append('m');
+}
+
+void appendMove(FrameBuffer& out, int row, int col) {
+    out.append("\033[");
+    out.appendInt(row + 1);
+    out.append(';');
+    out.appendInt(col + 1);
+    out.append('H');
+}
+
+// Длина UTF-8 последовательности по первому байту
+inline size_t utf8Length(unsigned char lead) {
+    if (lead < 0x80) return 1;
+    if ((lead & 0xe0) == 0xc0) return 2;
+    if ((lead & 0xf0) == 0xe0) return 3;
+    if ((lead & 0xf8) == 0xf0) return 4;
+    return 1;
+}
+
+} // namespace
+
+Screen::Screen() : rows(DEFAULT_ROWS), cols(DEFAULT_COLS), used_rows(0), clear_pending(true) {
+    resize();
+}
+
+void Screen::resize() {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        rows = ws.ws_row;
+        cols = ws.ws_col;
+    } else {
+        rows = DEFAULT_ROWS;
+        cols = DEFAULT_COLS;
+    }
+    invalidate();
+}
+
+void Screen::invalidate() {
+    clear_pending = true;
+}
+
+void Screen::present(std::string_view frame, bool ansi) {
+    output.clear();
+
+    if (!ansi) {
+        output.append(frame);
+        flush();
+        return;
+    }
+
+    if (clear_pending) {
+        // После очистки терминал показывает пустой экран - так и запоминаем
+        const Cell blank = {{' ', 0, 0, 0}, 1, 0};
+        front.assign(static_cast<size_t>(rows) * cols, blank);
+        output.append("\033[0m\033[2J");
+        clear_pending = false;
+    }
+
+    parse(frame);
+    diff();
+    flush();
+    front.swap(back);
+}
+
+void Screen::leave() {
+    output.clear();
+    appendMove(output, used_rows > 0 ? used_rows - 1 : 0, 0);
+    output.append("\033[0m");
+    flush();
+}
+
+void Screen::parse(std::string_view frame) {
+    const Cell blank = {{' ', 0, 0, 0}, 1, 0};
+    back.assign(static_cast<size_t>(rows) * cols, blank);
+
+    const char* p = frame.data();
+    const char* end = p + frame.size();
+    int row = 0;
+    int col = 0;
+    uint16_t style = 0;
+    used_rows = 0;
+
+    while (p < end) {
+        unsigned char c = static_cast<unsigned char>(*p);
+
+        if (c == '\033') {
+            // CSI: параметры до финального байта; учитываем только SGR
+            if (p + 1 < end && p[1] == '[') {
+                const char* q = p + 2;
+                while (q < end && (*q < 0x40 || *q > 0x7e)) ++q;
+                if (q < end && *q == 'm') {
+                    int param = 0;
+                    bool any = false;
+                    for (const char* s = p + 2; s <= q; ++s) {
+                        if (*s >= '0' && *s <= '9') {
+                            param = param * 10 + (*s - '0');
+                            any = true;
+                        } else {
+                            style = applySgr(style, any ? param : 0);
+                            param = 0;
+                            any = false;
+                        }
+                    }
+                }
+                p = q < end ? q + 1 : end;
+            } else {
+                p += p + 1 < end ? 2 : 1;
+            }
+            continue;
+        }
+
+        if (c == '\n') {
+            // Строки ниже экрана всё равно отбрасываются
+            if (++row >= rows) break;
+            col = 0;
+            ++p;
+            continue;
+        }
+        if (c < 0x20) {
+            ++p;
+            continue;
+        }
+
+        size_t len = utf8Length(c);
+        if (len > static_cast<size_t>(end - p)) len = static_cast<size_t>(end - p);
+
+        // Всё, что не помещается в терминал, отбрасываем
+        if (row < rows && col < cols) {
+            Cell& cell = back[static_cast<size_t>(row) * cols + col];
+            for (size_t i = 0; i < len; ++i) cell.glyph[i] = p[i];
+            cell.length = static_cast<uint8_t>(len);
+            cell.style = style;
+            if (row + 1 > used_rows) used_rows = row + 1;
+        }
+        ++col;
+        p += len;
+    }
+}
+
+void Screen::diff() {
+    // Положение курсора неизвестно до первого перемещения
+    int cursor_row = -1;
+    int cursor_col = -1;
+    uint16_t current_style = 0;
+    bool style_known = false;
+
+    for (int row = 0; row < rows; ++row) {
+        const size_t base = static_cast<size_t>(row) * cols;
+        int col = 0;
+        while (col < cols) {
+            if (back[base + col] == front[base + col]) {
+                ++col;
+                continue;
+            }
+
+            if (cursor_row == row && cursor_col <= col && col - cursor_col <= MAX_REWRITE_GAP) {
+                // Короткий промежуток перепечатываем вместо перемещения курсора
+                for (int gap = cursor_col; gap < col; ++gap) {
+                    const Cell& cell = back[base + gap];
+                    if (!style_known || cell.style != current_style) {
+                        appendStyle(output, cell.style);
+                        current_style = cell.style;
+                        style_known = true;
+                    }
+                    output.append(cell.glyph, cell.length);
+                }
+            } else {
+                appendMove(output, row, col);
+            }
+
+            const Cell& cell = back[base + col];
+            if (!style_known || cell.style != current_style) {
+                appendStyle(output, cell.style);
+                current_style = cell.style;
+                style_known = true;
+            }
+            output.append(cell.glyph, cell.length);
+
+            ++col;
+            cursor_row = row;
+            // В последней колонке курсор остаётся в состоянии переноса
+            cursor_col = col < cols ? col : cols + MAX_REWRITE_GAP + 1;
+        }
+    }
+
+    if (style_known && current_style != 0) {
+        output.append("\033[0m");
+    }
+}
+
+void Screen::flush() {
+    output.writeTo(STDOUT_FILENO);
+}
@@ -0,0 +1,64 @@
+#ifndef SCREEN_HPP
+#define SCREEN_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "frame_buffer.hpp"
+
+// Model of the terminal contents with a front (what the terminal shows) and
+// a back (the frame being presented) cell buffer.
+// present() parses a frame made of text, newlines and SGR colour sequences,
+// compares it with the previous one and writes only cursor moves and the
+// changed runs, all in a single write().
+//
+// Every UTF-8 code point takes one cell, which holds for the box drawing and
+// block characters mtop uses. A cell style packs the SGR state: attributes in
+// the low bits, then the foreground and background colour indices.
+class Screen {
+public:
+    Screen();
+    ~Screen() = default;
+
+    // Re-read the terminal size; the next frame is drawn in full
+    void resize();
+
+    // Forget what the terminal shows; the next frame is drawn in full
+    void invalidate();
+
+    // Show a frame. Without ANSI support the frame is written as is.
+    void present(std::string_view frame, bool ansi);
+
+    // Move the cursor below the drawn content (used before exiting)
+    void leave();
+
+    int width() const { return cols; }
+
+private:
+    struct Cell {
+        char glyph[4];
+        uint8_t length;
+        uint16_t style;
+
+        bool operator==(const Cell& other) const {
+            return length == other.length && style == other.style &&
+                   std::string::traits_type::compare(glyph, other.glyph, length) == 0;
+        }
+        bool operator!=(const Cell& other) const { return !(*this == other); }
+    };
+
+    int rows;
+    int cols;
+    int used_rows;
+    std::vector<Cell> front;
+    std::vector<Cell> back;
+    bool clear_pending;
+    FrameBuffer output;
+
+    void parse(std::string_view frame);
+    void diff();
+    void flush();
+};
+
+#endif // SCREEN_HPP
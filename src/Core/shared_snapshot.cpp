@@ -0,0 +1,410 @@
+#include "shared_snapshot.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[8] = {'M', 'T', 'O', 'P', 'S', 'H', 'M', '\0'};
+constexpr uint32_t VERSION = 3;
+
+constexpr size_t MAX_CORES = 1024;
+constexpr size_t MAX_INTERFACES = 64;
+constexpr size_t MAX_PROCESSES = 65536;
+constexpr size_t MAX_TREND = 32;
+
+int64_t monotonicMs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+}
+
+// Копирует строку в поле фиксированной длины; длиннее поля - обрезается
+template <size_t N>
+void copyText(char (&field)[N], const std::string& text) {
+    size_t length = std::min(text.size(), N - 1);
+    std::memcpy(field, text.data(), length);
+    std::memset(field + length, 0, N - length);
+}
+
+// Поле из сегмента может быть без завершающего нуля - не выходим за его размер
+template <size_t N>
+void readText(const char (&field)[N], std::string& text) {
+    text.assign(field, strnlen(field, N));
+}
+
+} // namespace
+
+struct SharedProcess {
+    int32_t pid;
+    int32_t ppid;
+    int32_t uid;
+    int32_t gid;
+    char state;
+    uint8_t kernel_thread;
+    uint8_t padding[2];
+    float cpu_system_percent; // user part is cpu_percent minus this
+    double cpu_percent;
+    uint64_t memory_kb;
+    uint64_t utime;
+    uint64_t stime;
+    uint64_t start_time;
+    char name[16]; // comm is at most 15 bytes
+    char user[32];
+    char group[32];
+};
+
+struct SharedInterface {
+    char name[16]; // IFNAMSIZ
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+    uint64_t rx_packets;
+    uint64_t tx_packets;
+};
+
+struct SharedSlot {
+    std::atomic<uint64_t> seq; // odd while the publisher is writing
+    double cpu_percent;
+    uint64_t total_memory_kb;
+    uint64_t used_memory_kb;
+    uint64_t free_memory_kb;
+    double load_avg[3];
+    int32_t process_count;
+    uint32_t core_count;
+    uint32_t interface_count;
+    uint32_t process_rows;
+    uint32_t cpu_trend_count;
+    uint32_t memory_trend_count;
+    CpuCoreStats cores[MAX_CORES];
+    HistoryPoint cpu_trend[MAX_TREND];
+    HistoryPoint memory_trend[MAX_TREND];
+    SharedInterface interfaces[MAX_INTERFACES];
+    SharedProcess processes[MAX_PROCESSES];
+};
+
+struct SharedSegment {
+    char magic[8];
+    uint32_t version;
+    int32_t publisher_pid;
+    int64_t interval_ms;
+    std::atomic<int64_t> heartbeat_ms; // CLOCK_MONOTONIC of the last publish, 0 = none yet
+    std::atomic<uint32_t> current;     // slot readers should copy
+    SharedSlot slots[2];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "seqlock needs lock-free 64-bit atomics");
+
+SharedPublisher::SharedPublisher() : segment(nullptr) {
+}
+
+SharedPublisher::~SharedPublisher() {
+    if (segment) {
+        munmap(segment, sizeof(SharedSegment));
+        shm_unlink(name.c_str());
+    }
+}
+
+bool SharedPublisher::create(const std::string& segment_name, int64_t interval_ms) {
+    int fd = shm_open(segment_name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        // Сегмент остался от упавшего публикатора - заменяем, если он не живой
+        SharedReader probe;
+        if (probe.attach(segment_name)) {
+            errno = EEXIST;
+            return false;
+        }
+        if (shm_unlink(segment_name.c_str()) != 0) return false;
+        fd = shm_open(segment_name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    }
+    if (fd < 0) return false;
+
+    // Зрители других пользователей только читают; umask не должен это запретить
+    if (fchmod(fd, 0644) != 0 || ftruncate(fd, sizeof(SharedSegment)) != 0) {
+        int saved_errno = errno;
+        close(fd);
+        shm_unlink(segment_name.c_str());
+        errno = saved_errno;
+        return false;
+    }
+
+    void* memory = mmap(nullptr, sizeof(SharedSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int saved_errno = errno;
+    close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(segment_name.c_str());
+        errno = saved_errno;
+        return false;
+    }
+
+    // ftruncate заполнил сегмент нулями; заголовок пишем последним
+    name = segment_name;
+    segment = static_cast<SharedSegment*>(memory);
+    segment->version = VERSION;
+    segment->publisher_pid = static_cast<int32_t>(getpid());
+    segment->interval_ms = interval_ms;
+    std::memcpy(segment->magic, MAGIC, sizeof(MAGIC));
+    return true;
+}
+
+void SharedPublisher::publish(const Snapshot& snapshot) {
+    const SystemStats& stats = snapshot.stats;
+    uint32_t next = (segment->current.load(std::memory_order_relaxed) + 1) & 1;
+    SharedSlot& slot = segment->slots[next];
+
+    // Нечётный счётчик: читатель этого слота повторит копирование
+    uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.cpu_percent = stats.cpu_percent;
+    slot.total_memory_kb = stats.total_memory_kb;
+    slot.used_memory_kb = stats.used_memory_kb;
+    slot.free_memory_kb = stats.free_memory_kb;
+    std::copy(stats.load_avg, stats.load_avg + 3, slot.load_avg);
+    slot.process_count = stats.process_count;
+
+    slot.core_count = static_cast<uint32_t>(std::min(stats.cpu_cores.size(), MAX_CORES));
+    std::copy_n(stats.cpu_cores.begin(), slot.core_count, slot.cores);
+    slot.cpu_trend_count = static_cast<uint32_t>(std::min(stats.cpu_trend.size(), MAX_TREND));
+    std::copy_n(stats.cpu_trend.end() - slot.cpu_trend_count, slot.cpu_trend_count, slot.cpu_trend);
+    slot.memory_trend_count = static_cast<uint32_t>(std::min(stats.memory_trend.size(), MAX_TREND));
+    std::copy_n(stats.memory_trend.end() - slot.memory_trend_count, slot.memory_trend_count, slot.memory_trend);
+
+    slot.interface_count = static_cast<uint32_t>(std::min(stats.network_interfaces.size(), MAX_INTERFACES));
+    for (uint32_t i = 0; i < slot.interface_count; ++i) {
+        const NetworkStats& net = stats.network_interfaces[i];
+        SharedInterface& out = slot.interfaces[i];
+        copyText(out.name, net.interface);
+        out.rx_bytes = net.rx_bytes;
+        out.tx_bytes = net.tx_bytes;
+        out.rx_packets = net.rx_packets;
+        out.tx_packets = net.tx_packets;
+    }
+
+    slot.process_rows = static_cast<uint32_t>(std::min(stats.processes.size(), MAX_PROCESSES));
+    for (uint32_t i = 0; i < slot.process_rows; ++i) {
+        const ProcessInfo& proc = stats.processes[i];
+        SharedProcess& out = slot.processes[i];
+        out.pid = proc.pid;
+        out.ppid = proc.ppid;
+        out.uid = proc.uid;
+        out.gid = proc.gid;
+        out.state = proc.state.empty() ? '?' : proc.state[0];
+        out.kernel_thread = proc.is_kernel_thread ? 1 : 0;
+        std::memset(out.padding, 0, sizeof(out.padding));
+        out.cpu_system_percent = static_cast<float>(proc.cpu_system_percent);
+        out.cpu_percent = proc.cpu_percent;
+        out.memory_kb = proc.memory_kb;
+        out.utime = proc.utime;
+        out.stime = proc.stime;
+        out.start_time = proc.start_time;
+        copyText(out.name, proc.name);
+        copyText(out.user, proc.user);
+        copyText(out.group, proc.group);
+    }
+
+    slot.seq.store(seq + 2, std::memory_order_release);
+    segment->current.store(next, std::memory_order_release);
+    segment->heartbeat_ms.store(monotonicMs(), std::memory_order_release);
+}
+
+MtopConfig SharedPublisher::collectionConfig(const MtopConfig& config) {
+    // Все процессы со всеми колонками: фильтры и сортировку применяет зритель
+    MtopConfig collect = config;
+    collect.max_processes = static_cast<int>(MAX_PROCESSES);
+    collect.sort_by = MtopConfig::SortBy::PID;
+    collect.reverse_sort = false;
+    collect.show_kernel_threads = true;
+    collect.hide_processes.clear();
+    collect.show_only_users.clear();
+    collect.filter.clear();
+    collect.show_process_state = true;
+    collect.show_process_user = true;
+    collect.show_process_group = true;
+    collect.show_sparklines = true;
+    collect.show_command_line = false; // зрители читают командные строки сами, только для своих строк
+    collect.show_threads = false;      // и потоки своих строк раскрывают тоже сами
+    collect.show_memory_detail = false;
+    return collect;
+}
+
+SharedReader::SharedReader() : segment(nullptr) {
+}
+
+SharedReader::~SharedReader() {
+    detach();
+}
+
+bool SharedReader::attach(const std::string& name) {
+    detach();
+
+    int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    // Чужой сегмент мог создать кто угодно - доверяем только root и себе
+    struct stat st;
+    bool trusted = fstat(fd, &st) == 0 && (st.st_uid == 0 || st.st_uid == geteuid()) &&
+                   static_cast<size_t>(st.st_size) >= sizeof(SharedSegment);
+    void* memory = trusted ? mmap(nullptr, sizeof(SharedSegment), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (memory == MAP_FAILED) return false;
+
+    segment = static_cast<const SharedSegment*>(memory);
+    if (std::memcmp(segment->magic, MAGIC, sizeof(MAGIC)) != 0 || segment->version != VERSION || !live()) {
+        detach();
+        return false;
+    }
+    return true;
+}
+
+void SharedReader::detach() {
+    if (segment) {
+        munmap(const_cast<SharedSegment*>(segment), sizeof(SharedSegment));
+        segment = nullptr;
+    }
+}
+
+int SharedReader::publisherPid() const {
+    return segment ? segment->publisher_pid : 0;
+}
+
+bool SharedReader::live() const {
+    if (!segment) return false;
+
+    // Процесс существует (EPERM - существует, но принадлежит другому пользователю)
+    pid_t pid = segment->publisher_pid;
+    if (pid <= 0 || (kill(pid, 0) != 0 && errno != EPERM)) return false;
+
+    // И публиковал недавно: пропущенные три интервала считаем зависанием
+    int64_t heartbeat = segment->heartbeat_ms.load(std::memory_order_acquire);
+    int64_t interval = std::max<int64_t>(segment->interval_ms, 0);
+    return heartbeat > 0 && monotonicMs() - heartbeat <= 3 * interval + 2000;
+}
+
+bool SharedReader::read(const MtopConfig& config, const ProcessFilter& filter, SystemStats& stats) {
+    if (!segment) return false;
+
+    bool consistent = false;
+    for (int attempt = 0; attempt < 8 && !consistent; ++attempt) {
+        const SharedSlot& slot = segment->slots[segment->current.load(std::memory_order_acquire) & 1];
+        uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq & 1) continue;
+
+        stats.cpu_percent = slot.cpu_percent;
+        stats.total_memory_kb = slot.total_memory_kb;
+        stats.used_memory_kb = slot.used_memory_kb;
+        stats.free_memory_kb = slot.free_memory_kb;
+        std::copy(slot.load_avg, slot.load_avg + 3, stats.load_avg);
+        stats.process_count = slot.process_count;
+
+        // Счётчики строк тоже могут быть посередине записи - ограничиваем их размерами массивов
+        size_t cores = std::min<size_t>(slot.core_count, MAX_CORES);
+        stats.cpu_cores.assign(slot.cores, slot.cores + cores);
+        size_t cpu_points = std::min<size_t>(slot.cpu_trend_count, MAX_TREND);
+        size_t memory_points = std::min<size_t>(slot.memory_trend_count, MAX_TREND);
+        stats.cpu_trend.assign(slot.cpu_trend, slot.cpu_trend + (config.show_sparklines ? cpu_points : 0));
+        stats.memory_trend.assign(slot.memory_trend, slot.memory_trend + (config.show_sparklines ? memory_points : 0));
+
+        size_t interfaces = std::min<size_t>(slot.interface_count, MAX_INTERFACES);
+        stats.network_interfaces.resize(interfaces);
+        for (size_t i = 0; i < interfaces; ++i) {
+            const SharedInterface& net = slot.interfaces[i];
+            NetworkStats& out = stats.network_interfaces[i];
+            readText(net.name, out.interface);
+            out.rx_bytes = net.rx_bytes;
+            out.tx_bytes = net.tx_bytes;
+            out.rx_packets = net.rx_packets;
+            out.tx_packets = net.tx_packets;
+        }
+
+        size_t count = std::min<size_t>(slot.process_rows, MAX_PROCESSES);
+        rows.resize(count);
+        std::memcpy(rows.data(), slot.processes, count * sizeof(SharedProcess));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        consistent = slot.seq.load(std::memory_order_relaxed) == seq;
+    }
+    if (!consistent) return false;
+
+    // Фильтр зрителя; в сегменте уже есть все поля, включая владельца
+    order.clear();
+    for (uint32_t i = 0; i < rows.size(); ++i) {
+        const SharedProcess& row = rows[i];
+        ProcessFilter::Row input;
+        input.pid = row.pid;
+        input.ppid = row.ppid;
+        input.state = row.state;
+        input.name = std::string_view(row.name, strnlen(row.name, sizeof(row.name)));
+        input.rss_kb = row.memory_kb;
+        input.cpu_percent = row.cpu_percent;
+        input.kernel_thread = row.kernel_thread != 0;
+        input.uid = row.uid;
+        input.gid = row.gid;
+        if (filter.evaluate(input, FilterStage::OWNER) == ProcessFilter::ACCEPT) {
+            order.push_back(i);
+        }
+    }
+
+    // Тот же порядок, что у SystemInfo: ключ сортировки, затем PID
+    auto before = [&](uint32_t a, uint32_t b) {
+        const SharedProcess& x = rows[config.reverse_sort ? b : a];
+        const SharedProcess& y = rows[config.reverse_sort ? a : b];
+        switch (config.sort_by) {
+            case MtopConfig::SortBy::MEMORY:
+                if (x.memory_kb != y.memory_kb) return x.memory_kb > y.memory_kb;
+                break;
+            case MtopConfig::SortBy::CPU:
+                if (x.cpu_percent != y.cpu_percent) return x.cpu_percent > y.cpu_percent;
+                break;
+            case MtopConfig::SortBy::PID:
+                break;
+            case MtopConfig::SortBy::NAME: {
+                int cmp = strncmp(x.name, y.name, sizeof(x.name));
+                if (cmp != 0) return cmp < 0;
+                break;
+            }
+        }
+        return x.pid < y.pid;
+    };
+    size_t limit = std::min(order.size(), static_cast<size_t>(std::max(0, config.max_processes)));
+    std::partial_sort(order.begin(), order.begin() + limit, order.end(), before);
+
+    // Строки создаём только для показываемых процессов
+    stats.processes.resize(limit);
+    for (size_t i = 0; i < limit; ++i) {
+        const SharedProcess& row = rows[order[i]];
+        ProcessInfo& proc = stats.processes[i];
+        proc.pid = row.pid;
+        proc.tgid = row.pid;
+        proc.ppid = row.ppid;
+        readText(row.name, proc.name);
+        proc.state.assign(1, row.state);
+        proc.cpu_percent = row.cpu_percent;
+        proc.cpu_system_percent = std::min<double>(row.cpu_system_percent, row.cpu_percent);
+        proc.cpu_user_percent = row.cpu_percent - proc.cpu_system_percent;
+        proc.memory_kb = row.memory_kb;
+        setMemoryDetail(proc, nullptr);
+        proc.uid = row.uid;
+        proc.gid = row.gid;
+        proc.is_kernel_thread = row.kernel_thread != 0;
+        proc.utime = row.utime;
+        proc.stime = row.stime;
+        proc.start_time = row.start_time;
+        if (config.show_process_user) readText(row.user, proc.user);
+        else proc.user.clear();
+        if (config.show_process_group) readText(row.group, proc.group);
+        else proc.group.clear();
+        if (config.show_command_line) proc.command = commands.get(proc.pid, proc.start_time, proc.name);
+        else proc.command.clear();
+    }
+    commands.endTick();
+    return true;
+}
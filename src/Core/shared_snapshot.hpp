@@ -0,0 +1,82 @@
+#ifndef SHARED_SNAPSHOT_HPP
+#define SHARED_SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "system_info.hpp"
+#include "process_filter.hpp"
+#include "command_line.hpp"
+#include "parser.hpp"
+
+struct SharedSegment;
+struct SharedProcess;
+
+// Snapshots shared between one collector and many viewers on a host
+// through a POSIX shared-memory segment (/dev/shm/mtop).
+//
+// The segment holds a header and two fixed-size slots. The publisher
+// writes the slot readers are not directed to, bracketed by an odd/even
+// sequence counter (a seqlock), and then points the header at it. A
+// reader copies the current slot and retries if the counter moved, which
+// only happens when the publisher lapped it twice during the copy.
+//
+// The publisher collects every process without filters; each viewer
+// applies its own filters, sort order and --max-processes to the copy.
+class SharedPublisher {
+public:
+    SharedPublisher();
+    ~SharedPublisher();
+
+    SharedPublisher(const SharedPublisher&) = delete;
+    SharedPublisher& operator=(const SharedPublisher&) = delete;
+
+    // Create the segment, replacing a stale one. Fails with EEXIST if
+    // another publisher is alive; otherwise errno describes the problem.
+    bool create(const std::string& name, int64_t interval_ms);
+
+    void publish(const Snapshot& snapshot);
+
+    // Configuration the publisher has to collect with
+    static MtopConfig collectionConfig(const MtopConfig& config);
+
+    static constexpr const char* DEFAULT_NAME = "/mtop";
+
+private:
+    std::string name;
+    SharedSegment* segment;
+};
+
+// Read-only view of a live publisher's segment
+class SharedReader {
+public:
+    SharedReader();
+    ~SharedReader();
+
+    SharedReader(const SharedReader&) = delete;
+    SharedReader& operator=(const SharedReader&) = delete;
+
+    // Attach only to a segment owned by root or by us whose publisher is alive
+    bool attach(const std::string& name);
+    void detach();
+
+    bool attached() const { return segment != nullptr; }
+    int publisherPid() const;
+
+    // Publisher process exists and has published recently
+    bool live() const;
+
+    // Copy the current sample into stats, keeping only the processes this
+    // viewer's filter and config would list, in its sort order. false if no
+    // consistent copy could be taken.
+    bool read(const MtopConfig& config, const ProcessFilter& filter, SystemStats& stats);
+
+private:
+    const SharedSegment* segment;
+    std::vector<SharedProcess> rows; // raw copy of the slot's process rows
+    std::vector<uint32_t> order;     // rows that pass the filters
+    CommandLineCache commands;       // the segment has no command lines
+};
+
+#endif // SHARED_SNAPSHOT_HPP
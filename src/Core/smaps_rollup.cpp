@@ -0,0 +1,178 @@
+#include "smaps_rollup.hpp"
+#include "system_info.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// Записи без обращений дольше этого числа тиков удаляются: процесс
+// завершился или давно не попадал ни в список, ни в фоновый обход
+constexpr uint64_t KEEP_TICKS = 256;
+
+int64_t monotonicNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+// Значение строки вида "Pss:     1234 kB"; p указывает сразу за именем поля
+uint64_t parseKb(const char* p, const char* end) {
+    while (p < end && *p == ' ') ++p;
+    uint64_t value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    return value;
+}
+
+bool startsWith(const char* line, const char* end, const char* prefix, size_t prefix_len) {
+    return static_cast<size_t>(end - line) >= prefix_len && std::memcmp(line, prefix, prefix_len) == 0;
+}
+
+} // namespace
+
+bool parseSmapsRollup(const char* data, size_t len, SmapsRollup& out) {
+    static constexpr char PSS[] = "Pss:";
+    static constexpr char PRIVATE_CLEAN[] = "Private_Clean:";
+    static constexpr char PRIVATE_DIRTY[] = "Private_Dirty:";
+    static constexpr char SWAP[] = "Swap:";
+
+    out = SmapsRollup{0, 0, 0};
+    bool found = false;
+    const char* end = data + len;
+
+    // Первая строка - заголовок диапазона адресов, дальше "Поле: N kB"
+    for (const char* line = data; line < end;) {
+        const char* next = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+        const char* line_end = next ? next : end;
+
+        if (startsWith(line, line_end, PSS, sizeof(PSS) - 1)) {
+            out.pss_kb = parseKb(line + sizeof(PSS) - 1, line_end);
+            found = true;
+        } else if (startsWith(line, line_end, PRIVATE_CLEAN, sizeof(PRIVATE_CLEAN) - 1)) {
+            out.uss_kb += parseKb(line + sizeof(PRIVATE_CLEAN) - 1, line_end);
+        } else if (startsWith(line, line_end, PRIVATE_DIRTY, sizeof(PRIVATE_DIRTY) - 1)) {
+            out.uss_kb += parseKb(line + sizeof(PRIVATE_DIRTY) - 1, line_end);
+        } else if (startsWith(line, line_end, SWAP, sizeof(SWAP) - 1)) {
+            out.swap_kb = parseKb(line + sizeof(SWAP) - 1, line_end);
+        }
+
+        line = next ? next + 1 : end;
+    }
+    return found;
+}
+
+bool readSmapsRollup(int pid, SmapsRollup& out) {
+    char path[40];
+    std::snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", pid);
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    // Весь файл - пара десятков строк, он помещается в буфер целиком
+    char buffer[4096];
+    size_t length = 0;
+    while (length < sizeof(buffer)) {
+        ssize_t n = ::read(fd, buffer + length, sizeof(buffer) - length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        length += static_cast<size_t>(n);
+    }
+    ::close(fd);
+
+    // У kernel threads файл пустой: памяти пользователя у них нет
+    if (length == 0) {
+        out = SmapsRollup{0, 0, 0};
+        return true;
+    }
+    return parseSmapsRollup(buffer, length, out);
+}
+
+void SmapsSampler::beginTick(int64_t budget_us) {
+    ++tick;
+    reads = 0;
+    deadline_ns = monotonicNs() + budget_us * 1000;
+}
+
+bool SmapsSampler::exhausted() const {
+    return reads > 0 && monotonicNs() >= deadline_ns;
+}
+
+const SmapsRollup* SmapsSampler::find(int pid, uint64_t start_time) {
+    auto it = entries.find(pid);
+    if (it == entries.end() || it->second.start_time != start_time) return nullptr;
+    it->second.last_used = tick;
+    return it->second.known ? &it->second.values : nullptr;
+}
+
+const SmapsRollup* SmapsSampler::sample(int pid, uint64_t start_time) {
+    auto it = entries.find(pid);
+    bool current = it != entries.end() && it->second.start_time == start_time;
+    if (current && it->second.read_tick == tick) {
+        it->second.last_used = tick;
+        return it->second.known ? &it->second.values : nullptr;
+    }
+
+    // Бюджет исчерпан - остаются значения прошлых тиков
+    if (exhausted()) {
+        return current ? find(pid, start_time) : nullptr;
+    }
+
+    Entry& entry = entries[pid];
+    if (!current) {
+        // Новый процесс или переиспользованный PID
+        entry.known = false;
+        entry.start_time = start_time;
+    }
+    SmapsRollup values;
+    ++reads;
+    if (readSmapsRollup(pid, values)) {
+        entry.values = values;
+        entry.known = true;
+    }
+    entry.read_tick = tick;
+    entry.last_used = tick;
+    return entry.known ? &entry.values : nullptr;
+}
+
+uint64_t SmapsSampler::lastRead(int pid, uint64_t start_time) const {
+    auto it = entries.find(pid);
+    return it != entries.end() && it->second.start_time == start_time ? it->second.read_tick : 0;
+}
+
+void SmapsSampler::sampleListed(std::vector<ProcessInfo>& processes) {
+    // Давно не читанные - первыми; при равенстве - в порядке списка
+    order.resize(processes.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return lastRead(processes[a].pid, processes[a].start_time) <
+               lastRead(processes[b].pid, processes[b].start_time);
+    });
+
+    for (uint32_t i : order) {
+        if (exhausted()) break;
+        sample(processes[i].pid, processes[i].start_time);
+    }
+    for (ProcessInfo& proc : processes) {
+        setMemoryDetail(proc, find(proc.pid, proc.start_time));
+    }
+}
+
+void SmapsSampler::endTick() {
+    if (tick % KEEP_TICKS != 0) return;
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (tick - it->second.last_used > KEEP_TICKS) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
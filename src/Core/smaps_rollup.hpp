@@ -0,0 +1,75 @@
+#ifndef SMAPS_ROLLUP_HPP
+#define SMAPS_ROLLUP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Memory of one process from /proc/PID/smaps_rollup (Linux 4.14+), in KiB
+struct SmapsRollup {
+    uint64_t pss_kb;  // proportional set size: shared pages split between their users
+    uint64_t uss_kb;  // unique set size: Private_Clean + Private_Dirty
+    uint64_t swap_kb;
+};
+
+struct ProcessInfo;
+
+// Parse the text of smaps_rollup; false if it has none of the fields
+bool parseSmapsRollup(const char* data, size_t len, SmapsRollup& out);
+
+// Read /proc/PID/smaps_rollup. Needs ptrace read access to the process,
+// so other users' processes usually fail without root.
+bool readSmapsRollup(int pid, SmapsRollup& out);
+
+// smaps_rollup walks every mapping of the process in the kernel, so a read
+// can take milliseconds for a large one. Reads are done under a per-tick
+// time budget: callers ask for the rows that matter most first, and once
+// the budget is spent every process keeps its last values. The first read
+// of a tick is always done, so even a tiny budget makes progress. Results are
+// keyed by (pid, start_time), so a recycled PID never shows stale numbers.
+class SmapsSampler {
+public:
+    SmapsSampler() : tick(0), deadline_ns(0), reads(0) {}
+
+    // Start a tick with budget_us microseconds for reads
+    void beginTick(int64_t budget_us);
+
+    // Last values of a process, re-read first if they are not from this
+    // tick and budget is left. nullptr if the process was never read.
+    const SmapsRollup* sample(int pid, uint64_t start_time);
+
+    // Values without reading; nullptr if there are none
+    const SmapsRollup* find(int pid, uint64_t start_time);
+
+    // Refresh the listed processes, stalest first, and fill in their
+    // memory detail. Going by age rather than by position keeps one slow
+    // process at the top from using up the budget of every tick.
+    void sampleListed(std::vector<ProcessInfo>& processes);
+
+    bool exhausted() const;
+
+    // Forget processes that have not been looked at for a while
+    void endTick();
+
+    size_t size() const { return entries.size(); }
+
+private:
+    struct Entry {
+        uint64_t start_time;
+        uint64_t read_tick;
+        uint64_t last_used;
+        bool known; // false, если файл не прочитался
+        SmapsRollup values;
+    };
+
+    std::unordered_map<int, Entry> entries;
+    uint64_t tick;
+    int64_t deadline_ns;
+    size_t reads; // прочитано в этом тике
+    std::vector<uint32_t> order;
+
+    uint64_t lastRead(int pid, uint64_t start_time) const;
+};
+
+#endif // SMAPS_ROLLUP_HPP
@@ -0,0 +1,18 @@
+#include "string_interner.hpp"
+
+uint32_t StringInterner::intern(std::string_view value) {
+    auto it = index.find(value);
+    if (it != index.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.emplace_back(value);
+    index.emplace(std::string_view(strings.back()), id);
+    return id;
+}
+
+void StringInterner::clear() {
+    index.clear();
+    strings.clear();
+}
@@ -0,0 +1,30 @@
+#ifndef STRING_INTERNER_HPP
+#define STRING_INTERNER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Stores each distinct string once and hands out small integer ids.
+// References returned by get() stay valid until clear().
+class StringInterner {
+public:
+    StringInterner() = default;
+    ~StringInterner() = default;
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    uint32_t intern(std::string_view value);
+    const std::string& get(uint32_t id) const { return strings[id]; }
+    size_t size() const { return strings.size(); }
+    void clear();
+
+private:
+    std::deque<std::string> strings; // deque не перемещает элементы при росте
+    std::unordered_map<std::string_view, uint32_t> index;
+};
+
+#endif // STRING_INTERNER_HPP
@@ -0,0 +1,72 @@
+#include "substring_matcher.hpp"
+#include <cstring>
+
+SubstringMatcher::SubstringMatcher() : class_count(1) {
+    std::memset(byte_class, 0, sizeof(byte_class));
+    next.assign(1, 0);
+    accepting.assign(1, 0);
+}
+
+void SubstringMatcher::build(const std::vector<std::string>& patterns) {
+    // Класс 0 - байты, которых нет ни в одном шаблоне
+    std::memset(byte_class, 0, sizeof(byte_class));
+    class_count = 1;
+    for (const auto& pattern : patterns) {
+        for (unsigned char c : pattern) {
+            // Если в шаблонах все 256 байт, последнему достаётся класс 0 - других там уже нет
+            if (byte_class[c] == 0 && class_count < 256) byte_class[c] = static_cast<uint8_t>(class_count++);
+        }
+    }
+
+    // Бор: 0 в таблице переходов означает "нет ребра" (в корень рёбра не ведут)
+    next.assign(class_count, 0);
+    accepting.assign(1, 0);
+    for (const auto& pattern : patterns) {
+        uint32_t state = 0;
+        for (unsigned char c : pattern) {
+            uint32_t& edge = next[state * class_count + byte_class[c]];
+            if (edge == 0) {
+                edge = static_cast<uint32_t>(accepting.size());
+                accepting.push_back(0);
+                next.resize(next.size() + class_count, 0);
+            }
+            state = next[state * class_count + byte_class[c]];
+        }
+        accepting[state] = 1;
+    }
+
+    // Обход в ширину: недостающие переходы берём у суффиксной ссылки,
+    // так что автомат превращается в полный ДКА
+    std::vector<uint32_t> fail(accepting.size(), 0);
+    std::vector<uint32_t> queue;
+    queue.reserve(accepting.size());
+    for (uint32_t c = 0; c < class_count; ++c) {
+        uint32_t child = next[c];
+        if (child != 0) queue.push_back(child);
+    }
+    for (size_t head = 0; head < queue.size(); ++head) {
+        uint32_t state = queue[head];
+        if (accepting[fail[state]]) accepting[state] = 1;
+        for (uint32_t c = 0; c < class_count; ++c) {
+            uint32_t& edge = next[state * class_count + c];
+            uint32_t fallback = next[fail[state] * class_count + c];
+            if (edge != 0) {
+                fail[edge] = fallback;
+                queue.push_back(edge);
+            } else {
+                edge = fallback;
+            }
+        }
+    }
+}
+
+bool SubstringMatcher::matches(std::string_view text) const {
+    if (accepting[0]) return true; // пустой шаблон совпадает с чем угодно
+
+    uint32_t state = 0;
+    for (unsigned char c : text) {
+        state = next[state * class_count + byte_class[c]];
+        if (accepting[state]) return true;
+    }
+    return false;
+}
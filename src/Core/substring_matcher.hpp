@@ -0,0 +1,28 @@
+#ifndef SUBSTRING_MATCHER_HPP
+#define SUBSTRING_MATCHER_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Tests whether a text contains any of a set of byte strings.
+// Built as an Aho-Corasick automaton and flattened into a DFA over the
+// byte classes that occur in the patterns, so a match costs one table
+// lookup per input byte however many patterns there are.
+class SubstringMatcher {
+public:
+    SubstringMatcher();
+
+    void build(const std::vector<std::string>& patterns);
+
+    bool matches(std::string_view text) const;
+
+private:
+    uint8_t byte_class[256];
+    uint32_t class_count;
+    std::vector<uint32_t> next; // state * class_count + class -> state
+    std::vector<uint8_t> accepting;
+};
+
+#endif // SUBSTRING_MATCHER_HPP
@@ -2,20 +2,48 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
-#include <filesystem>
-#include <pwd.h>
+#include <atomic>
+#include <thread>
+#include <ctime>
 #include <unistd.h>
 
-SystemInfo::SystemInfo(const MtopConfig& cfg) : config(cfg), prev_total_time(0), prev_idle_time(0) {
-    updateStats();
+namespace {
+
+// RSS в /proc/PID/stat - в страницах, размер которых зависит от архитектуры
+const uint64_t PAGE_KB = [] {
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? static_cast<uint64_t>(size) / 1024 : 4;
+}();
+
+} // namespace
+
+std::shared_ptr<Snapshot> SnapshotPool::acquire() {
+    // use_count() == 1 значит, что снимок держит только пул: читатели его отпустили
+    for (auto& snapshot : snapshots) {
+        if (snapshot.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return snapshot;
+        }
+    }
+    
+    auto snapshot = std::make_shared<Snapshot>();
+    if (snapshots.size() < max_pooled) {
+        snapshots.push_back(snapshot);
+    }
+    return snapshot;
 }
 
-SystemStats SystemInfo::getStats() {
-    return stats;
+SystemInfo::SystemInfo(const MtopConfig& cfg)
+    : config(cfg), sequence(0), smaps_shard(0), smaps_row(0) {
+    configureCollector();
+    compileFilter();
+    updateStats();
 }
 
 void SystemInfo::updateConfig(const MtopConfig& new_config) {
     config = new_config;
+    configureCollector();
+    compileFilter();
 }
 
 void SystemInfo::updateStats() {
@@ -24,52 +52,30 @@ void SystemInfo::updateStats() {
     readLoadAverage();
     readNetworkStats();
     readProcesses();
-    applyProcessFilters();
-    sortProcesses();
+    recordHistory();
+    
+    // Потоки раскрываются после истории: она ведётся по процессам
+    if (config.show_threads) {
+        threads.expand(config, stats.processes);
+    }
+    
+    // Публикуем снимок: присваивание переиспользует память переработанного снимка
+    std::shared_ptr<Snapshot> next = snapshots.acquire();
+    next->sequence = ++sequence;
+    next->stats = stats;
+    latest = std::move(next);
 }
 
 void SystemInfo::readCpuStats() {
-    try {
-        std::ifstream file("/proc/stat");
-        if (!file.is_open()) {
-            stats.cpu_percent = 0.0;
-            return;
-        }
-        
-        std::string line;
-        if (std::getline(file, line)) {
-            std::istringstream iss(line);
-            std::string cpu_label;
-            uint64_t user, nice, system, idle, iowait, irq, softirq, steal;
-            
-            if (iss >> cpu_label >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal) {
-                uint64_t total_time = user + nice + system + idle + iowait + irq + softirq + steal;
-                uint64_t idle_time = idle + iowait;
-                
-                stats.cpu_percent = calculateCpuPercent(total_time, idle_time);
-                
-                prev_total_time = total_time;
-                prev_idle_time = idle_time;
-            } else {
-                stats.cpu_percent = 0.0;
-            }
-        } else {
-            stats.cpu_percent = 0.0;
-        }
-    } catch (const std::exception&) {
+    // Все строки cpu/cpuN читаются одним проходом
+    if (!cpu_reader.update()) {
         stats.cpu_percent = 0.0;
+        stats.cpu_cores.clear();
+        return;
     }
-}
-
-double SystemInfo::calculateCpuPercent(uint64_t total_time, uint64_t idle_time) {
-    if (prev_total_time == 0) return 0.0;
-    
-    uint64_t total_diff = total_time - prev_total_time;
-    uint64_t idle_diff = idle_time - prev_idle_time;
-    
-    if (total_diff == 0) return 0.0;
     
-    return 100.0 * (1.0 - static_cast<double>(idle_diff) / total_diff);
+    stats.cpu_percent = cpu_reader.aggregate().total;
+    stats.cpu_cores = cpu_reader.cores();
 }
 
 void SystemInfo::readMemoryStats() {
@@ -135,189 +141,387 @@ void SystemInfo::readLoadAverage() {
 }
 
 void SystemInfo::readProcesses() {
-    stats.processes.clear();
-    stats.processes.reserve(config.max_processes + 50); // Резервируем память
     stats.process_count = 0;
+    plan = CollectionPlan::fromConfig(config);
     
-    try {
-        for (const auto& entry : std::filesystem::directory_iterator("/proc")) {
-            if (!entry.is_directory()) continue;
-            
-            const std::string& filename = entry.path().filename().string();
-            if (!std::all_of(filename.begin(), filename.end(), ::isdigit)) continue;
-            
-            int pid = std::stoi(filename);
-            ProcessInfo proc;
-            proc.pid = pid;
-            proc.is_kernel_thread = false;
-            
-            // Читаем /proc/PID/stat
-            std::ifstream stat_file("/proc/" + filename + "/stat");
-            if (!stat_file.is_open()) continue;
-            
-            std::string stat_line;
-            std::getline(stat_file, stat_line);
-            
-            // Парсим строку stat правильно - имя процесса может содержать пробелы в скобках
-            size_t first_paren = stat_line.find('(');
-            size_t last_paren = stat_line.rfind(')');
-            
-            if (first_paren == std::string::npos || last_paren == std::string::npos) {
-                continue;
-            }
-            
-            // Извлекаем имя процесса (между скобками)
-            proc.name = stat_line.substr(first_paren + 1, last_paren - first_paren - 1);
-            
-            // Парсим остальные поля после закрывающей скобки
-            std::string remaining = stat_line.substr(last_paren + 1);
-            std::istringstream iss(remaining);
-            
-            std::vector<std::string> fields;
-            std::string field;
-            while (iss >> field) {
-                fields.push_back(field);
-            }
-            
-            if (fields.size() >= 22) {
-                proc.state = fields[0]; // Первое поле после имени - состояние
-                
-                // Проверяем, является ли процесс kernel thread
-                int ppid = std::stoi(fields[1]);
-                if (ppid == 2 || (proc.name.front() == '[' && proc.name.back() == ']')) {
-                    proc.is_kernel_thread = true;
-                }
-                
-                // Получаем CPU времена: utime (11), stime (12), starttime (19)
-                proc.utime = std::stoull(fields[11]);
-                proc.stime = std::stoull(fields[12]);
-                proc.start_time = std::stoull(fields[19]);
-                
-                // RSS находится в поле 21 (после имени и состояния)
-                uint64_t rss = std::stoull(fields[21]);
-                proc.memory_kb = rss * 4; // RSS в страницах по 4KB
-            } else {
-                continue; // Пропускаем процесс если данных недостаточно
-            }
-            
-            // Читаем /proc/PID/status для получения UID
-            std::ifstream status_file("/proc/" + filename + "/status");
-            std::string status_line;
-            proc.uid = 0;
-            
-            while (std::getline(status_file, status_line)) {
-                if (status_line.substr(0, 4) == "Uid:") {
-                    std::istringstream uid_iss(status_line);
-                    std::string uid_label;
-                    uid_iss >> uid_label >> proc.uid;
-                    break;
-                }
+    // Проценты CPU считаются по реальному времени между сканами
+    sample_clock.tick();
+    // id из имён пользователей в фильтре могли устареть вместе с кэшем
+    if (identities.refresh()) compileFilter();
+    
+    // Собираем список PID одним проходом getdents64
+    pid_enumerator.scan("/proc");
+    const std::vector<int>& pids = pid_enumerator.ids();
+    
+    // Раскладываем PID по шардам: один и тот же PID всегда попадает в один шард,
+    // поэтому кэш дескрипторов и таблицы шарда не разделяются между потоками
+    for (auto& shard : shards) {
+        shard->pids.clear();
+    }
+    for (int pid : pids) {
+        shards[static_cast<size_t>(pid) % shards.size()]->pids.push_back(pid);
+    }
+    
+    if (pool && shards.size() > 1) {
+        pool->run(shards.size(), [this](size_t index) { scanShard(*shards[index]); });
+    } else {
+        for (auto& shard : shards) {
+            scanShard(*shard);
+        }
+    }
+    
+    // Выбираем лучшие строки по плотным колонкам всех шардов
+    const size_t limit = static_cast<size_t>(std::max(0, config.max_processes));
+    selection.reset(limit, RowOrder{&shards, config.sort_by, config.reverse_sort});
+    for (size_t s = 0; s < shards.size(); ++s) {
+        const ProcessShard& shard = *shards[s];
+        for (uint32_t row : shard.visible_rows) {
+            selection.push(RowRef{static_cast<uint32_t>(s), row});
+        }
+        stats.process_count += static_cast<int>(shard.scanned);
+    }
+    const std::vector<RowRef>& best = selection.finish();
+    
+    // Строки создаём только для процессов, которые попадут на экран
+    stats.processes.resize(best.size());
+    for (size_t i = 0; i < best.size(); ++i) {
+        ProcessShard& shard = *shards[best[i].shard];
+        ProcessTable& table = shard.current;
+        const size_t row = best[i].row;
+        ProcessInfo& proc = stats.processes[i];
+        
+        proc.pid = table.pid[row];
+        proc.tgid = proc.pid;
+        proc.ppid = table.ppid[row];
+        proc.name = shard.names.get(table.name_id[row]);
+        proc.state.assign(1, table.state[row]);
+        proc.cpu_percent = table.cpu_percent[row];
+        proc.memory_kb = table.rss_kb[row];
+        proc.uid = table.uid[row];
+        proc.gid = table.gid[row];
+        proc.is_kernel_thread = table.kernel_thread[row] != 0;
+        proc.utime = table.utime[row];
+        proc.stime = table.stime[row];
+        proc.start_time = table.start_time[row];
+        splitProcessCpu(shard, proc);
+        
+        // Владельца, не понадобившегося фильтру, читаем только для показываемых строк
+        // и запоминаем в таблице: следующий тик возьмёт его оттуда
+        if (plan.reads(ProcSource::OWNER) && proc.uid < 0) {
+            ProcOwner owner;
+            if (shard.stat_reader.readOwner(proc.pid, proc.start_time, owner)) {
+                table.uid[row] = proc.uid = static_cast<int>(owner.uid);
+                table.gid[row] = proc.gid = static_cast<int>(owner.gid);
             }
-            
-            proc.user = getUserName(proc.uid);
-            
-            // Вычисляем CPU процент если есть предыдущие данные
-            auto prev_it = prev_processes.find(proc.pid);
-            if (prev_it != prev_processes.end()) {
-                proc.cpu_percent = calculateProcessCpuPercent(proc, prev_it->second);
-            } else {
-                proc.cpu_percent = 0.0;
+        }
+        
+        if (plan.reads(ProcSource::CMDLINE)) {
+            proc.command = commands.get(proc.pid, proc.start_time, proc.name);
+        } else {
+            proc.command.clear();
+        }
+        
+        // Кэш имён не потокобезопасен, поэтому имена получаем здесь.
+        // Владелец мог не прочитаться (процесс завершился, нет доступа) - тогда "?"
+        if (plan.needs(ProcField::USER)) {
+            if (proc.uid >= 0) proc.user = identities.userName(static_cast<uint32_t>(proc.uid));
+            else proc.user.assign(1, '?');
+        } else {
+            proc.user.clear();
+        }
+        if (plan.needs(ProcField::GROUP)) {
+            if (proc.gid >= 0) proc.group = identities.groupName(static_cast<uint32_t>(proc.gid));
+            else proc.group.assign(1, '?');
+        } else {
+            proc.group.clear();
+        }
+    }
+    commands.endTick();
+    
+    // Бюджет smaps_rollup: сначала показываемые строки, остаток - остальным
+    if (plan.reads(ProcSource::SMAPS)) {
+        smaps.beginTick(static_cast<int64_t>(config.smaps_budget_ms) * 1000);
+        smaps.sampleListed(stats.processes);
+        refreshMemoryDetail();
+        smaps.endTick();
+    } else {
+        for (ProcessInfo& proc : stats.processes) {
+            setMemoryDetail(proc, nullptr);
+        }
+    }
+}
+
+void SystemInfo::refreshMemoryDetail() {
+    // Остаток бюджета уходит на остальные процессы по кругу, с того места,
+    // где остановился прошлый тик: попав в список, они уже будут с данными.
+    // Строки таблиц сдвигаются между тиками, поэтому круг приблизительный
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard->current.size();
+    }
+    
+    for (size_t visited = 0; visited < total && !smaps.exhausted();) {
+        if (smaps_shard >= shards.size()) smaps_shard = 0;
+        const ProcessTable& table = shards[smaps_shard]->current;
+        if (smaps_row >= table.size()) {
+            smaps_shard++;
+            smaps_row = 0;
+            continue;
+        }
+        smaps.sample(table.pid[smaps_row], table.start_time[smaps_row]);
+        smaps_row++;
+        visited++;
+    }
+}
+
+void SystemInfo::scanShard(ProcessShard& shard) {
+    // Счётчики и таблица прошлого тика становятся базой для расчёта CPU
+    // и источником неизменных атрибутов
+    shard.counters.beginTick(shard.pids.size());
+    std::swap(shard.current, shard.previous);
+    shard.current.clear();
+    shard.current.reserve(shard.pids.size());
+    shard.visible_rows.clear();
+    shard.scanned = 0;
+    shard.reuse_previous = true;
+    
+    // Имена умерших процессов копятся в пуле; сбрасываем его, когда он сильно
+    // больше живого набора. Id имён в прошлой таблице после этого недействительны
+    if (shard.names.size() > 4 * shard.pids.size() + 1024) {
+        shard.names.clear();
+        shard.reuse_previous = false;
+    }
+    
+    shard.stat_reader.beginScan();
+    
+    // Процесс, отсеянный по одному PID, считаем, но не читаем
+    if (filter.uses(FilterStage::PID)) {
+        size_t kept = 0;
+        for (int pid : shard.pids) {
+            ProcessFilter::Row input;
+            input.pid = pid;
+            if (filter.evaluate(input, FilterStage::PID) == ProcessFilter::REJECT) {
+                shard.scanned++;
+                continue;
             }
-            
-            stats.processes.push_back(proc);
-            stats.process_count++;
+            shard.pids[kept++] = pid;
         }
-    } catch (const std::exception&) {
-        // Игнорируем ошибки чтения процессов
+        shard.pids.resize(kept);
+    }
+    
+    const bool batched = shard.stat_reader.usingRing();
+    for (size_t i = 0; i < shard.pids.size(); ++i) {
+        // С io_uring файлы stat читаются пачками, readProcess берёт готовое
+        if (batched && i % ProcStatReader::BATCH_SIZE == 0) {
+            shard.stat_reader.prefetch(&shard.pids[i], std::min(ProcStatReader::BATCH_SIZE, shard.pids.size() - i));
+        }
+        
+        int pid = shard.pids[i];
+        if (!readProcess(pid, shard)) continue;
+        
+        shard.scanned++;
+        size_t row = shard.current.size() - 1;
+        if (shouldShowProcess(shard, row)) {
+            shard.visible_rows.push_back(static_cast<uint32_t>(row));
+        }
+    }
+    
+    shard.stat_reader.endScan();
+}
+
+bool SystemInfo::readProcess(int pid, ProcessShard& shard) const {
+    // Читаем и разбираем /proc/PID/stat без промежуточных строк.
+    // Владельца здесь не читаем: он нужен только фильтру или показываемым строкам
+    ProcStat stat;
+    if (!shard.stat_reader.read(pid, stat) || stat.comm_len == 0) return false;
+    
+    ProcessTable& table = shard.current;
+    size_t row = table.appendRow();
+    std::string_view comm(stat.comm, stat.comm_len);
+    
+    table.pid[row] = pid;
+    table.ppid[row] = stat.ppid; // меняется, когда родитель завершается
+    table.state[row] = stat.state;
+    table.utime[row] = stat.utime;
+    table.stime[row] = stat.stime;
+    table.start_time[row] = stat.start_time;
+    table.rss_kb[row] = stat.rss_pages * PAGE_KB;
+    
+    // Базу ищем по (pid, starttime): переиспользованный PID начинает с нуля
+    const ProcessCounters* previous = shard.counters.previous(pid, stat.start_time);
+    if (previous) {
+        table.cpu_percent[row] = calculateProcessCpuPercent(stat.utime + stat.stime,
+                                                            previous->utime + previous->stime);
+    }
+    shard.counters.record(pid, stat.start_time,
+                          ProcessCounters{stat.utime, stat.stime, static_cast<uint32_t>(row)});
+    
+    // Имя, владелец и признак kernel thread не меняются, пока жив процесс:
+    // берём их из прошлой строки. Другое имя значит exec() - тогда всё заново
+    const ProcessTable& last = shard.previous;
+    if (previous && shard.reuse_previous && previous->row < last.size() &&
+        shard.names.get(last.name_id[previous->row]) == comm) {
+        table.name_id[row] = last.name_id[previous->row];
+        table.uid[row] = last.uid[previous->row];
+        table.gid[row] = last.gid[previous->row];
+        table.kernel_thread[row] = last.kernel_thread[previous->row];
+        return true;
+    }
+    
+    table.name_id[row] = shard.names.intern(comm);
+    
+    // Проверяем, является ли процесс kernel thread
+    if (stat.ppid == 2 || (stat.comm[0] == '[' && stat.comm[stat.comm_len - 1] == ']')) {
+        table.kernel_thread[row] = 1;
+    }
+    
+    return true;
+}
+
+void SystemInfo::configureCollector() {
+    size_t threads = config.collector_threads > 0
+        ? static_cast<size_t>(config.collector_threads)
+        : std::max(1u, std::thread::hardware_concurrency());
+    
+    // Несколько шардов на поток, чтобы было что воровать при неравномерной нагрузке
+    size_t shard_count = threads > 1 ? threads * 4 : 1;
+    
+    if (threads > 1) {
+        if (!pool || pool->size() != threads) {
+            pool = std::make_unique<WorkStealingPool>(threads);
+        }
+    } else {
+        pool.reset();
     }
     
-    // Обновляем предыдущие данные о процессах
-    prev_processes.clear();
-    for (const auto& proc : stats.processes) {
-        prev_processes[proc.pid] = proc;
+    if (shards.size() != shard_count) {
+        shards.clear();
+        for (size_t i = 0; i < shard_count; ++i) {
+            shards.push_back(std::make_unique<ProcessShard>(config.max_cached_fds, shard_count));
+        }
+    } else {
+        for (auto& shard : shards) {
+            shard->stat_reader.setFdBudget(config.max_cached_fds, shard_count);
+        }
+    }
+    
+    // Без поддержки io_uring читатель сам остаётся на обычных вызовах
+    for (auto& shard : shards) {
+        shard->stat_reader.useRing(config.scan_backend != MtopConfig::ScanBackend::SYNC);
     }
 }
 
-void SystemInfo::applyProcessFilters() {
-    // Фильтруем процессы согласно конфигурации
-    auto it = std::remove_if(stats.processes.begin(), stats.processes.end(),
-                             [this](const ProcessInfo& proc) {
-                                 return !shouldShowProcess(proc);
-                             });
-    stats.processes.erase(it, stats.processes.end());
-    
-    // Ограничиваем количество процессов
-    if (stats.processes.size() > static_cast<size_t>(config.max_processes)) {
-        stats.processes.resize(config.max_processes);
+void SystemInfo::compileFilter() {
+    // Выражение проверено при запуске; если оно всё же не собралось, остаются старые фильтры
+    std::string error;
+    if (!filter.compile(config, identities, error)) {
+        MtopConfig fallback = config;
+        fallback.filter.clear();
+        filter.compile(fallback, identities, error);
     }
 }
 
-bool SystemInfo::shouldShowProcess(const ProcessInfo& proc) const {
-    // Проверяем kernel threads
-    if (proc.is_kernel_thread && !config.show_kernel_threads) {
-        return false;
+bool SystemInfo::shouldShowProcess(ProcessShard& shard, size_t row) const {
+    ProcessTable& table = shard.current;
+    
+    ProcessFilter::Row input;
+    input.pid = table.pid[row];
+    input.ppid = table.ppid[row];
+    input.state = table.state[row];
+    input.name = shard.names.get(table.name_id[row]);
+    input.rss_kb = table.rss_kb[row];
+    input.cpu_percent = table.cpu_percent[row];
+    input.kernel_thread = table.kernel_thread[row] != 0;
+    
+    // Сначала всё, что известно из stat; fstat() - только если этого не хватило
+    // и владелец не достался от прошлого тика
+    ProcessFilter::Result result = filter.evaluate(input, FilterStage::STAT);
+    if (result != ProcessFilter::UNDECIDED) {
+        return result == ProcessFilter::ACCEPT;
     }
     
-    // Проверяем скрытые процессы
-    for (const auto& hidden : config.hide_processes) {
-        if (proc.name.find(hidden) != std::string::npos) {
+    if (table.uid[row] < 0) {
+        ProcOwner owner;
+        if (!shard.stat_reader.readOwner(input.pid, table.start_time[row], owner)) {
             return false;
         }
+        table.uid[row] = static_cast<int>(owner.uid);
+        table.gid[row] = static_cast<int>(owner.gid);
     }
+    input.uid = table.uid[row];
+    input.gid = table.gid[row];
+    return filter.evaluate(input, FilterStage::OWNER) == ProcessFilter::ACCEPT;
+}
+
+bool SystemInfo::RowOrder::operator()(const RowRef& a, const RowRef& b) const {
+    // Строгий порядок: при reverse просто меняем аргументы местами
+    const RowRef& first = reverse ? b : a;
+    const RowRef& second = reverse ? a : b;
+    const ProcessShard& first_shard = *(*shards)[first.shard];
+    const ProcessShard& second_shard = *(*shards)[second.shard];
+    const ProcessTable& x = first_shard.current;
+    const ProcessTable& y = second_shard.current;
     
-    // Проверяем фильтр по пользователям
-    if (!config.show_only_users.empty()) {
-        bool found = false;
-        for (const auto& user : config.show_only_users) {
-            if (proc.user == user) {
-                found = true;
-                break;
+    switch (sort_by) {
+        case MtopConfig::SortBy::MEMORY:
+            if (x.rss_kb[first.row] != y.rss_kb[second.row]) return x.rss_kb[first.row] > y.rss_kb[second.row];
+            break;
+        case MtopConfig::SortBy::CPU:
+            if (x.cpu_percent[first.row] != y.cpu_percent[second.row]) {
+                return x.cpu_percent[first.row] > y.cpu_percent[second.row];
             }
+            break;
+        case MtopConfig::SortBy::PID:
+            break;
+        case MtopConfig::SortBy::NAME: {
+            int cmp = first_shard.names.get(x.name_id[first.row]).compare(
+                second_shard.names.get(y.name_id[second.row]));
+            if (cmp != 0) return cmp < 0;
+            break;
         }
-        if (!found) return false;
     }
     
-    return true;
+    return x.pid[first.row] < y.pid[second.row];
 }
 
-void SystemInfo::sortProcesses() {
-    std::sort(stats.processes.begin(), stats.processes.end(),
-              [this](const ProcessInfo& a, const ProcessInfo& b) {
-                  bool result = false;
-                  
-                  switch (config.sort_by) {
-                      case MtopConfig::SortBy::MEMORY:
-                          result = a.memory_kb > b.memory_kb;
-                          break;
-                      case MtopConfig::SortBy::CPU:
-                          result = a.cpu_percent > b.cpu_percent;
-                          break;
-                      case MtopConfig::SortBy::PID:
-                          result = a.pid < b.pid;
-                          break;
-                      case MtopConfig::SortBy::NAME:
-                          result = a.name < b.name;
-                          break;
-                  }
-                  
-                  return config.reverse_sort ? !result : result;
-              });
+double SystemInfo::calculateProcessCpuPercent(uint64_t current_time, uint64_t previous_time) const {
+    // Счётчики процесса не убывают; если всё же убыли, считаем, что времени не было
+    uint64_t ticks = current_time > previous_time ? current_time - previous_time : 0;
+    return taskCpuPercent(ticks, sample_clock.interval());
 }
 
-double SystemInfo::calculateProcessCpuPercent(const ProcessInfo& current, const ProcessInfo& previous) {
-    uint64_t total_time_diff = (current.utime + current.stime) - (previous.utime + previous.stime);
-    uint64_t system_time_diff = prev_total_time - 0; // Используем системное время между обновлениями
-    
-    if (system_time_diff == 0) return 0.0;
+void SystemInfo::splitProcessCpu(const ProcessShard& shard, ProcessInfo& proc) const {
+    // Прошлые счётчики ещё лежат в базовом поколении до следующего скана
+    const ProcessCounters* previous = shard.counters.previous(proc.pid, proc.start_time);
+    if (!previous) {
+        proc.cpu_user_percent = proc.cpu_system_percent = 0.0;
+        return;
+    }
+    proc.cpu_user_percent = calculateProcessCpuPercent(proc.utime, previous->utime);
+    proc.cpu_system_percent = calculateProcessCpuPercent(proc.stime, previous->stime);
+}
+
+void SystemInfo::recordHistory() {
+    // Точек в спарклайне рядом с полосами CPU и MEM
+    constexpr size_t TREND_POINTS = 20;
     
-    // Получаем количество CPU ядер
-    static long cpu_cores = sysconf(_SC_NPROCESSORS_ONLN);
-    if (cpu_cores <= 0) cpu_cores = 1;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t now_ms = static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
     
-    // Конвертируем в проценты
-    double cpu_percent = (100.0 * total_time_diff * cpu_cores) / system_time_diff;
+    double memory_percent = stats.total_memory_kb > 0
+        ? static_cast<double>(stats.used_memory_kb) / stats.total_memory_kb * 100.0 : 0.0;
+    history.recordSystem(now_ms, stats.cpu_percent, memory_percent);
     
-    return std::min(cpu_percent, 100.0 * cpu_cores); // Ограничиваем максимумом
+    if (config.show_sparklines) {
+        int64_t interval_ms = config.interval_ms > 0 ? config.interval_ms : config.update_interval * 1000;
+        int level = History::levelFor(interval_ms);
+        history.system(History::CPU).recent(level, TREND_POINTS, stats.cpu_trend);
+        history.system(History::MEMORY).recent(level, TREND_POINTS, stats.memory_trend);
+    } else {
+        stats.cpu_trend.clear();
+        stats.memory_trend.clear();
+    }
 }
 
 void SystemInfo::readNetworkStats() {
@@ -370,8 +574,3 @@ void SystemInfo::readNetworkStats() {
         stats.network_interfaces.clear();
     }
 }
-
-std::string SystemInfo::getUserName(int uid) {
-    struct passwd* pw = getpwuid(uid);
-    return pw ? std::string(pw->pw_name) : std::to_string(uid);
-}
\ No newline at end of file
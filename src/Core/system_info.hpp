@@ -5,22 +5,57 @@
 #include <vector>
 #include <cstdint>
 #include <unordered_map>
+#include <memory>
 #include "parser.hpp"
+#include "proc_stat.hpp"
+#include "proc_dir.hpp"
+#include "identity_cache.hpp"
+#include "collection_plan.hpp"
+#include "process_filter.hpp"
+#include "command_line.hpp"
+#include "smaps_rollup.hpp"
+#include "top_k.hpp"
+#include "process_table.hpp"
+#include "counter_table.hpp"
+#include "cpu_stats.hpp"
+#include "thread_sampler.hpp"
+#include "history.hpp"
+#include "string_interner.hpp"
+#include "thread_pool.hpp"
 
 struct ProcessInfo {
-    int pid;
+    int pid;  // thread id in the thread view
+    int tgid; // owning process; equal to pid for process rows
+    int ppid;
     std::string name;
+    std::string command; // full command line, only when show_command_line is set
     std::string state;
-    double cpu_percent;
-    uint64_t memory_kb;
+    double cpu_percent;        // over the last interval, 100% = one CPU
+    double cpu_user_percent;   // user and system parts of cpu_percent
+    double cpu_system_percent;
+    uint64_t memory_kb;        // RSS
+    uint64_t pss_kb;           // smaps_rollup, only when show_memory_detail is set
+    uint64_t uss_kb;
+    uint64_t swap_kb;
+    bool memory_detail;        // false until smaps_rollup has been read
     std::string user;
+    std::string group;
     int uid;
+    int gid;
     bool is_kernel_thread;
     uint64_t utime;
     uint64_t stime;
     uint64_t start_time;
 };
 
+// Copy smaps_rollup values into a row; nullptr leaves them unknown
+inline void setMemoryDetail(ProcessInfo& proc, const SmapsRollup* detail) {
+    proc.memory_detail = detail != nullptr;
+    proc.pss_kb = detail ? detail->pss_kb : 0;
+    proc.uss_kb = detail ? detail->uss_kb : 0;
+    proc.swap_kb = detail ? detail->swap_kb : 0;
+}
+
 struct NetworkStats {
     std::string interface;
     uint64_t rx_bytes;
@@ -31,6 +66,7 @@ struct NetworkStats {
 
 struct SystemStats {
     double cpu_percent;
+    std::vector<CpuCoreStats> cpu_cores;
     uint64_t total_memory_kb;
     uint64_t used_memory_kb;
     uint64_t free_memory_kb;
@@ -38,6 +74,33 @@ struct SystemStats {
     int process_count;
     std::vector<ProcessInfo> processes;
     std::vector<NetworkStats> network_interfaces;
+    
+    // Recent history for sparklines, oldest first
+    std::vector<HistoryPoint> cpu_trend;
+    std::vector<HistoryPoint> memory_trend;
+};
+
+// Immutable result of one collection pass.
+// Readers hold it through SnapshotPtr and never copy the statistics.
+struct Snapshot {
+    uint64_t sequence = 0;
+    SystemStats stats;
+};
+
+using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+// Recycles snapshots once no reader references them any more, so vectors
+// and strings inside keep their capacity and publishing does not allocate.
+class SnapshotPool {
+public:
+    explicit SnapshotPool(size_t max_pooled = 4) : max_pooled(max_pooled) {}
+    
+    // Returns a snapshot nobody else holds; its contents are stale
+    std::shared_ptr<Snapshot> acquire();
+    
+private:
+    size_t max_pooled;
+    std::vector<std::shared_ptr<Snapshot>> snapshots;
 };
 
 class SystemInfo {
@@ -45,30 +108,82 @@ public:
     SystemInfo(const MtopConfig& config);
     ~SystemInfo() = default;
     
-    SystemStats getStats();
+    // Latest published snapshot; cheap to call and safe to keep
+    SnapshotPtr getSnapshot() const { return latest; }
     void updateStats();
     void updateConfig(const MtopConfig& new_config);
     
 private:
     SystemStats stats;
     MtopConfig config;
-    uint64_t prev_total_time;
-    uint64_t prev_idle_time;
-    std::unordered_map<int, ProcessInfo> prev_processes;
+    SnapshotPool snapshots;
+    SnapshotPtr latest;
+    uint64_t sequence;
+    SampleClock sample_clock; // интервал между сканами процессов
+    CpuStatsReader cpu_reader;
+    History history;
+    
+    // Часть PID-пространства, которую сканирует один поток.
+    // Счётчики прошлого тика для расчёта CPU хранятся в двух поколениях,
+    // таблица прошлого тика - источник неизменных атрибутов процессов
+    struct ProcessShard {
+        ProcessShard(int max_cached_fds, size_t shard_count)
+            : stat_reader(max_cached_fds, shard_count), scanned(0), reuse_previous(false) {}
+        
+        ProcStatReader stat_reader;
+        std::vector<int> pids;
+        ProcessTable current;
+        ProcessTable previous;
+        CounterHistory counters;
+        StringInterner names;
+        std::vector<uint32_t> visible_rows;
+        size_t scanned;
+        bool reuse_previous; // false, если id имён прошлого тика уже недействительны
+    };
+    
+    // Ссылка на строку таблицы конкретного шарда
+    struct RowRef {
+        uint32_t shard;
+        uint32_t row;
+    };
+    
+    // Порядок отображения по активному ключу сортировки
+    struct RowOrder {
+        const std::vector<std::unique_ptr<ProcessShard>>* shards = nullptr;
+        MtopConfig::SortBy sort_by = MtopConfig::SortBy::MEMORY;
+        bool reverse = false;
+        bool operator()(const RowRef& a, const RowRef& b) const;
+    };
+    
+    std::vector<std::unique_ptr<ProcessShard>> shards;
+    std::unique_ptr<WorkStealingPool> pool;
+    PidEnumerator pid_enumerator;
+    IdentityCache identities;
+    CommandLineCache commands;
+    SmapsSampler smaps;
+    size_t smaps_shard;  // позиция фонового обхода smaps_rollup
+    size_t smaps_row;
+    CollectionPlan plan;
+    TopK<RowRef, RowOrder> selection;
+    ProcessFilter filter;
+    ThreadSampler threads;
     
+    void configureCollector();
+    void compileFilter();
     void readCpuStats();
     void readMemoryStats();
     void readProcesses();
+    void scanShard(ProcessShard& shard);
+    void refreshMemoryDetail();
+    bool readProcess(int pid, ProcessShard& shard) const;
     void readLoadAverage();
     void readNetworkStats();
-    std::string getUserName(int uid);
-    double calculateCpuPercent(uint64_t total_time, uint64_t idle_time);
-    double calculateProcessCpuPercent(const ProcessInfo& current, const ProcessInfo& previous);
+    void recordHistory();
+    double calculateProcessCpuPercent(uint64_t current_time, uint64_t previous_time) const;
+    void splitProcessCpu(const ProcessShard& shard, ProcessInfo& proc) const;
     
     // Process filtering
-    bool shouldShowProcess(const ProcessInfo& proc) const;
-    void sortProcesses();
-    void applyProcessFilters();
+    bool shouldShowProcess(ProcessShard& shard, size_t row) const;
 };
 
 #endif // SYSTEM_INFO_HPP
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "thread_pool.hpp"
+
+WorkStealingPool::WorkStealingPool(size_t thread_count)
+    : current_task(nullptr), job_id(0), stopping(false), remaining(0) {
+    if (thread_count == 0) thread_count = 1;
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    // Очередь 0 обслуживает вызывающий поток
+    for (size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake_cv.notify_all();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::run(size_t task_count, const std::function<void(size_t)>& task) {
+    if (task_count == 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current_task = &task;
+        remaining.store(task_count, std::memory_order_relaxed);
+
+        // Раскладываем задачи по очередям по кругу
+        for (size_t i = 0; i < task_count; ++i) {
+            WorkQueue& queue = *queues[i % queues.size()];
+            std::lock_guard<std::mutex> queue_lock(queue.mutex);
+            queue.tasks.push_back(i);
+        }
+        ++job_id;
+    }
+    wake_cv.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [this] { return remaining.load(std::memory_order_acquire) == 0; });
+    current_task = nullptr;
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    uint64_t seen_job = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake_cv.wait(lock, [&] { return stopping || job_id != seen_job; });
+            if (stopping) return;
+            seen_job = job_id;
+        }
+
+        drain(index);
+    }
+}
+
+void WorkStealingPool::drain(size_t index) {
+    size_t task;
+    while (popLocal(index, task) || steal(index, task)) {
+        (*current_task)(task);
+
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done_cv.notify_all();
+        }
+    }
+}
+
+bool WorkStealingPool::popLocal(size_t index, size_t& task) {
+    WorkQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t index, size_t& task) {
+    // Забираем задачи с хвоста чужих очередей
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkQueue& victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) continue;
+
+        task = victim.tasks.back();
+        victim.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,55 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fork-join pool with per-worker task queues.
+// Each worker drains its own queue first and then steals from the others,
+// so uneven shards do not leave threads idle.
+class WorkStealingPool {
+public:
+    // thread_count includes the calling thread, which also executes tasks
+    explicit WorkStealingPool(size_t thread_count);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const { return queues.size(); }
+
+    // Run task(0) .. task(task_count - 1) and wait for all of them
+    void run(size_t task_count, const std::function<void(size_t)>& task);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable wake_cv;
+    std::condition_variable done_cv;
+    const std::function<void(size_t)>* current_task;
+    uint64_t job_id;
+    bool stopping;
+    std::atomic<size_t> remaining;
+
+    void workerLoop(size_t index);
+    void drain(size_t index);
+    bool popLocal(size_t index, size_t& task);
+    bool steal(size_t index, size_t& task);
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,110 @@
+#include "thread_sampler.hpp"
+#include "system_info.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+// Дескрипторы потоков кэшируем понемногу: основной бюджет принадлежит
+// сканеру процессов, остальные потоки читаются через open/pread/close
+constexpr int THREAD_FD_BUDGET = 64;
+
+} // namespace
+
+ThreadSampler::ThreadSampler() : stat_reader(THREAD_FD_BUDGET) {}
+ThreadSampler::~ThreadSampler() = default;
+
+void ThreadSampler::expand(const MtopConfig& config, std::vector<ProcessInfo>& processes) {
+    const double interval = clock.tick();
+    const size_t limit = static_cast<size_t>(std::max(0, config.max_processes));
+
+    counters.beginTick(processes.size() * 8);
+    stat_reader.beginScan();
+    selection.reset(limit, ThreadOrder{&processes, config.sort_by, config.reverse_sort});
+
+    for (size_t p = 0; p < processes.size(); ++p) {
+        const ProcessInfo& proc = processes[p];
+        // Процесс успел завершиться - его потоков уже нет
+        if (!tasks.scanTasks(proc.pid)) continue;
+
+        for (int tid : tasks.ids()) {
+            ProcStat stat;
+            if (!stat_reader.readTask(proc.pid, tid, stat)) continue;
+
+            ThreadRow row;
+            row.tid = tid;
+            row.process = static_cast<uint32_t>(p);
+            row.state = stat.state;
+            row.name_len = static_cast<uint8_t>(std::min(stat.comm_len, sizeof(row.name)));
+            std::memcpy(row.name, stat.comm, row.name_len);
+            row.utime = stat.utime;
+            row.stime = stat.stime;
+            row.start_time = stat.start_time;
+            row.cpu_percent = row.cpu_user_percent = row.cpu_system_percent = 0.0;
+
+            // Как и у процессов, базу ищем по (tid, starttime)
+            const ProcessCounters* previous = counters.previous(tid, stat.start_time);
+            if (previous) {
+                uint64_t user = stat.utime > previous->utime ? stat.utime - previous->utime : 0;
+                uint64_t system = stat.stime > previous->stime ? stat.stime - previous->stime : 0;
+                row.cpu_user_percent = taskCpuPercent(user, interval);
+                row.cpu_system_percent = taskCpuPercent(system, interval);
+                row.cpu_percent = taskCpuPercent(user + system, interval);
+            }
+            counters.record(tid, stat.start_time, ProcessCounters{stat.utime, stat.stime, 0});
+            selection.push(row);
+        }
+    }
+    stat_reader.endScan();
+
+    // Строки потоков наследуют у процесса всё, чего нет в stat потока
+    const std::vector<ThreadRow>& best = selection.finish();
+    rows.resize(best.size());
+    for (size_t i = 0; i < best.size(); ++i) {
+        const ThreadRow& thread = best[i];
+        const ProcessInfo& proc = processes[thread.process];
+        ProcessInfo& row = rows[i];
+
+        row = proc;
+        row.pid = thread.tid;
+        row.tgid = proc.pid;
+        row.name.assign(thread.name, thread.name_len);
+        row.state.assign(1, thread.state);
+        row.cpu_percent = thread.cpu_percent;
+        row.cpu_user_percent = thread.cpu_user_percent;
+        row.cpu_system_percent = thread.cpu_system_percent;
+        row.utime = thread.utime;
+        row.stime = thread.stime;
+        row.start_time = thread.start_time;
+    }
+    processes.swap(rows);
+}
+
+bool ThreadSampler::ThreadOrder::operator()(const ThreadRow& a, const ThreadRow& b) const {
+    // Строгий порядок: при reverse просто меняем аргументы местами
+    const ThreadRow& x = reverse ? b : a;
+    const ThreadRow& y = reverse ? a : b;
+
+    switch (sort_by) {
+        case MtopConfig::SortBy::MEMORY: {
+            // Память у потоков общая, поэтому это порядок процессов
+            uint64_t x_memory = (*processes)[x.process].memory_kb;
+            uint64_t y_memory = (*processes)[y.process].memory_kb;
+            if (x_memory != y_memory) return x_memory > y_memory;
+            break;
+        }
+        case MtopConfig::SortBy::CPU:
+            if (x.cpu_percent != y.cpu_percent) return x.cpu_percent > y.cpu_percent;
+            break;
+        case MtopConfig::SortBy::PID:
+            break;
+        case MtopConfig::SortBy::NAME: {
+            int cmp = std::string_view(x.name, x.name_len).compare(std::string_view(y.name, y.name_len));
+            if (cmp != 0) return cmp < 0;
+            break;
+        }
+    }
+
+    return x.tid < y.tid;
+}
@@ -0,0 +1,65 @@
+#ifndef THREAD_SAMPLER_HPP
+#define THREAD_SAMPLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "parser.hpp"
+#include "proc_dir.hpp"
+#include "proc_stat.hpp"
+#include "counter_table.hpp"
+#include "cpu_stats.hpp"
+#include "top_k.hpp"
+
+struct ProcessInfo;
+
+// Per-thread view of the listed processes.
+// Only the processes that already made it into the list are expanded, so
+// the cost is their /proc/PID/task entries rather than every thread on the
+// host: finding the hot thread of a 2000-thread JVM reads 2000 small files,
+// not the whole system. Thread CPU is computed from the thread's own
+// utime/stime deltas; memory, owner and command line are the process's.
+class ThreadSampler {
+public:
+    ThreadSampler();
+    ~ThreadSampler();
+
+    ThreadSampler(const ThreadSampler&) = delete;
+    ThreadSampler& operator=(const ThreadSampler&) = delete;
+
+    // Replace the processes with their threads, ordered by the configured
+    // sort key and cut to max_processes rows
+    void expand(const MtopConfig& config, std::vector<ProcessInfo>& processes);
+
+private:
+    // Поток, прочитанный в этом тике; строка ProcessInfo создаётся только для отобранных
+    struct ThreadRow {
+        int tid;
+        uint32_t process; // индекс процесса во входном списке
+        char state;
+        uint8_t name_len;
+        char name[16];
+        double cpu_percent;
+        double cpu_user_percent;
+        double cpu_system_percent;
+        uint64_t utime;
+        uint64_t stime;
+        uint64_t start_time;
+    };
+
+    struct ThreadOrder {
+        const std::vector<ProcessInfo>* processes = nullptr;
+        MtopConfig::SortBy sort_by = MtopConfig::SortBy::CPU;
+        bool reverse = false;
+        bool operator()(const ThreadRow& a, const ThreadRow& b) const;
+    };
+
+    PidEnumerator tasks;
+    ProcStatReader stat_reader;
+    CounterHistory counters;
+    SampleClock clock;
+    TopK<ThreadRow, ThreadOrder> selection;
+    std::vector<ProcessInfo> rows;
+};
+
+#endif // THREAD_SAMPLER_HPP
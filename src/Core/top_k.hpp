@@ -0,0 +1,50 @@
+#ifndef TOP_K_HPP
+#define TOP_K_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Keeps the best `capacity` values seen so far in a bounded heap.
+// Compare(a, b) must return true when a ranks before b; the heap front is
+// then the worst kept value and is the one replaced by better candidates.
+template <typename T, typename Compare>
+class TopK {
+public:
+    TopK() : capacity(0), compare() {}
+
+    void reset(size_t new_capacity, Compare new_compare) {
+        capacity = new_capacity;
+        compare = new_compare;
+        heap.clear();
+        heap.reserve(capacity);
+    }
+
+    void push(const T& value) {
+        if (capacity == 0) return;
+
+        if (heap.size() < capacity) {
+            heap.push_back(value);
+            std::push_heap(heap.begin(), heap.end(), compare);
+        } else if (compare(value, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), compare);
+            heap.back() = value;
+            std::push_heap(heap.begin(), heap.end(), compare);
+        }
+    }
+
+    // Sort kept values best-first; the heap is consumed
+    std::vector<T>& finish() {
+        std::sort_heap(heap.begin(), heap.end(), compare);
+        return heap;
+    }
+
+    size_t size() const { return heap.size(); }
+
+private:
+    size_t capacity;
+    Compare compare;
+    std::vector<T> heap;
+};
+
+#endif // TOP_K_HPP